@@ -1,225 +1,673 @@
 #include "assembler.h"
 
+#include <limits.h>
+
 /* ___The Assembler___ */
 int main(int argc, char *argv[])
 {
 	/* ___Declarations___ */
-	/* the array that will represent the code image */
-	short int codeImage[RAM_SIZE] = {PLACEHOLDER};
-
-	/* the array that will represent the data image - dynamically allocated */
-	short int *dataImage = NULL;
+	/* the reserved names, hashed in memory */
+	resNamesIndex resNames = {{NULL, 0, 0}, {NULL, 0, 0}};
 
-	/* symbols will be stored in a linked list */
-	symbolNode *head = NULL;
+	/* the tables every file is assembled with */
+	asmContext context;
 
-	/* a linked list that stores the codeImage cells that need labels for the second pass */
-	needLabelNode *nlHead = NULL;
+	/* additional */
+	int res,
+		workers = DEFAULT_SERVER_WORKERS;
 
-	/* a pointer to a new file containing reserved names */
-	FILE *resNamesP = NULL;
+	char *socketName;
 
-	/* additional */
-	int index,
-		ppRes,
-		fpRes,
-		spRes;
+	stageTime started;
 
-	const char *stage = "assembler";
-	char	resNames[] = "reserved_names";
+	/* errors are printed to stderr */
+	const errStage asmStage = {"assembler", NULL},
+				   *stage = &asmStage;
 
 	/* ocList, dirList - definitions of the opcodes and directives that will be referenced throughout the program  */
 	OC_LIST_DEC
 	DIR_LIST_DEC
 
+	/* ___The client mode - the files are assembled by a running server___ */
+	if (argc > 1 && strcmp(argv[1], OPT_CONNECT) == 0)
+	{
+		if (argc < 3)
+		{
+			err_wo_line(stage, asmblrErrList[ASMBLR_ERR_UNKNOWN_OPTION], argv[1]);
+			return QUIT_UPON_ERROR;
+		}
+
+		/* the request's command line is the program's name, followed by the arguments after the socket */
+		socketName = argv[2];
+		argv[2] = argv[0];
+		return run_client(stage, socketName, argc - 2, argv + 2);
+	}
+
+	/* ___Creating the reserved names index, shared by all of the files___ */
+	/* its time is measured for -stats, which is only known once the options of a request are read */
+	context.resNamesTime.wall = context.resNamesTime.cpu = 0;
+	read_clock(&started, FALSE);
+	if (build_res_names(&resNames, ocList, dirList) == FUNC_ERROR)
+	{
+		err_wo_line(stage, asmblrErrList[ASMBLR_ERR_RES_NAMES], NULL);
+		free_res_names(&resNames);
+		return QUIT_UPON_ERROR;
+	}
+	add_elapsed(&context.resNamesTime, &started, FALSE);
+
+	context.resNames = &resNames;
+	context.ocList = ocList;
+	context.dirList = dirList;
+
+	/* ___The server mode - requests are handled by resident workers, with the tables already built___ */
+	if (argc > 1 && strcmp(argv[1], OPT_SERVE) == 0)
+	{
+		if (argc == 3 || (argc == 5 && strcmp(argv[3], OPT_JOBS) == 0 && (workers = atoi(argv[4])) > 0))
+			res = serve_requests(stage, argv[2], workers, assemble_request, &context);
+		else
+		{
+			err_wo_line(stage, asmblrErrList[ASMBLR_ERR_UNKNOWN_OPTION], argv[1]);
+			res = QUIT_UPON_ERROR;
+		}
+	}
+	else
+		res = assemble_request(argc, argv, &context);
+
+	free_res_names(&resNames);
+	return res;
+}
+
+/* Assembles the files of a command line - of the program's own, or of a request to the server.
+   Parameters:
+   - argc, argv: The command line, with the options before the files.
+   - context: The asmContext, with the tables the files are assembled with.
+
+   Returns:
+   - 0 (SUCCESS) if all of the files were assembled with no errors.
+   - -1 (QUIT_UPON_ERROR) otherwise.
+*/
+int assemble_request(int argc, char *argv[], void *context)
+{
+	/* the command line options */
+	asmOptions options = {FALSE, FALSE, 1, FALSE, NULL, NULL, FALSE, FALSE, 0, FALSE, FALSE};
+
+	/* the files of this command line, with the shared tables */
+	asmContext files = *(asmContext *)context;
+
+	/* the tables of a file, whose memory is reused by the files after it */
+	fileState state = {{PLACEHOLDER}, {NULL, 0, 0}, {NULL, 0, 0, NULL, 0, 0}, {NULL, 0, 0, NULL, 0, NULL, 0, NULL},
+					   {NULL, 0, 0}, {NULL, 0, 0, NULL, 0, 0}, {NULL, 0, 0, NULL, 0, 0, 0, 0}, {{NULL, 0, 0}}};
+
+	/* the names of a list of files, when the files are not given on the command line */
+	char **listNames = NULL,
+		 *listChars = NULL;
+
+	/* additional */
+	int index,
+		firstFile,
+		res,
+		failed = 0,
+		restored = 0,
+		shared;
+
+	poolJob *jobs = NULL;
+
+	int *results;
+
+	/* the time of the whole run, for -stats */
+	stageTime runStarted,
+		runTime = {0, 0};
+
+	/* errors are printed to stderr */
+	const errStage asmStage = {"assembler", NULL},
+				   *stage = &asmStage;
+
 	/* ___Starting to process the command line input___ */
-	if (argc < MIN_ARGS)
+	if ((firstFile = parse_options(stage, argc, argv, &options)) == FUNC_ERROR)
+		return QUIT_UPON_ERROR;
+
+	if (options.listName != NULL && (argc > firstFile || options.fromStdin))
+	{
+		err_wo_line(stage, asmblrErrList[ASMBLR_ERR_LIST_FILES], NULL);
+		return QUIT_UPON_ERROR;
+	}
+
+	if (options.listName == NULL && argc - firstFile < MIN_ARGS - 1)
 	{
 		err_wo_line(stage, asmblrErrList[ASMBLR_ERR_MISSING_ARGS], NULL);
 		return QUIT_UPON_ERROR;
 	}
 
+	if (options.fromStdin && argc - firstFile > 1)
+	{
+		err_wo_line(stage, asmblrErrList[ASMBLR_ERR_STDIN_FILES], NULL);
+		return QUIT_UPON_ERROR;
+	}
+
+	if (options.cacheDir != NULL && open_cache(stage, options.cacheDir) == FUNC_ERROR)
+		return QUIT_UPON_ERROR;
+
+	/* ___The files are given on the command line, or read from a list___ */
+	if (options.listName != NULL)
+	{
+		if ((listNames = read_file_list(stage, &options, &listChars, &files.fileCount)) == NULL)
+			return QUIT_UPON_ERROR;
+		files.files = listNames;
+	}
+	else
+	{
+		files.files = argv + firstFile;
+		files.fileCount = argc - firstFile;
+	}
+	files.options = &options;
+	files.state = &state;
+	state.symbols.names = &state.names;
+	state.diags.limit = options.maxErrors;
+
+	/* one more than needed, so an empty list is not a failed allocation */
+	if ((results = (int *)malloc((files.fileCount + 1) * sizeof(int))) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		free(listNames);
+		free(listChars);
+		return QUIT_UPON_ERROR;
+	}
+
+	/* what every file takes - the workers write it into memory they share with this process */
+	shared = (options.jobs > 1 && files.fileCount > 1);
+	files.stats = NULL;
+	if (options.stats && (files.stats = alloc_file_stats(files.fileCount, shared)) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		free(results);
+		free(listNames);
+		free(listChars);
+		return QUIT_UPON_ERROR;
+	}
+	read_clock(&runStarted, TRUE);
+
 	/* ___Processing each file of the given arguments___ */
-	for (index = 1; index < argc; index++)
+	if (options.jobs > 1 && files.fileCount > 1)
 	{
-		char    *woExtension = NULL,
-		        *nameToPrint = NULL;
-		
-		/* ___Creating a reserved names list, individual to the current file ___ */
-		if ((resNamesP = build_res_names(stage, resNames, ocList, dirList)) == NULL)
+		/* in parallel - the largest files first, with their output printed in the order of the arguments */
+		if ((jobs = (poolJob *)malloc(files.fileCount * sizeof(poolJob))) == NULL)
 		{
-			err_wo_line(stage, asmblrErrList[ASMBLR_ERR_FILE_CREATION], resNames);
+			err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+			free_file_stats(files.stats, files.fileCount, shared);
+			free(results);
+			free(listNames);
+			free(listChars);
 			return QUIT_UPON_ERROR;
 		}
-		fclose(resNamesP);
-		resNamesP = NULL;
-		
-		SEPERATOR
-		/* if the given argument is a file path, we'll extract the file's name */
-		if (strrchr(argv[index], '/') != NULL)
+		for (index = 0; index < files.fileCount; index++)
 		{
-			woExtension = (char *)malloc(strlen(strrchr(argv[index], '/')));
-			if (woExtension == NULL)
-			{
-				err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
-				break;
-			}
-			strcpy(woExtension, strrchr(argv[index], '/'));
-			nameToPrint = woExtension+1;
-			
-			printf("Now processing \"%s.as\":\n", nameToPrint);
+			char *ipName = add_ext(files.files[index], ".as");
+
+			jobs[index].job = index;
+			jobs[index].size = (ipName != NULL) ? input_size(ipName) : 0;
+			free(ipName);
 		}
-		else
-			printf("Now processing \"%s.as\":\n", argv[index]);
 
-		ppRes = pre_process(argv[index], resNames);
-		if (ppRes == QUIT_UPON_ERROR)
-			continue;
+		res = run_worker_pool(stage, options.jobs, jobs, files.fileCount, assemble_job, &files, results);
+		free(jobs);
+		if (res == FUNC_ERROR)
+		{
+			free_file_stats(files.stats, files.fileCount, shared);
+			free(results);
+			free(listNames);
+			free(listChars);
+			return QUIT_UPON_ERROR;
+		}
+	}
+	else
+	{
+		for (index = 0; index < files.fileCount; index++)
+			results[index] = assemble_job(index, &files);
+	}
 
-		fpRes = first_pass(argv[index], resNames, codeImage, &dataImage, ocList, dirList, &head, &nlHead);
-		spRes = second_pass(argv[index], resNames, codeImage, dataImage, ocList, dirList, &head, &nlHead, !((ppRes < 0) || (fpRes < 0)), fpRes);
+	for (index = 0; index < files.fileCount; index++)
+	{
+		if (results[index] == FILE_RESTORED)
+			restored++;
+		else if (results[index] != FILE_ASSEMBLED)
+		{
+			/* a worker that did not finish failed its file */
+			results[index] = FILE_FAILED;
+			failed++;
+		}
 
-		if (spRes == SUCCESS)
-			printf("\nThe file was successfully processed with no errors detected.\n");
-		else 
-			printf("\nThe file processing is finished, please review the listed errors.\n");
+		if (files.stats != NULL)
+			files.stats[index].result = fileResultNames[results[index]];
+	}
 
-		if (index != (argc - 1))
-			printf("Moving to the next file.\n");
-		else
-		{	SEPERATOR
-			printf("\nDone processing for all files.\n");
-		}
+	if (options.cacheDir != NULL)
+		printf("Cache: %d hits, %d misses.\n\n", restored, files.fileCount - restored);
 
-		printf("\n");
+	if (files.stats != NULL)
+	{
+		add_elapsed(&runTime, &runStarted, TRUE);
+		print_stats(files.files, files.stats, files.fileCount, &files.resNamesTime, &runTime);
+		free_file_stats(files.stats, files.fileCount, shared);
+	}
+
+	free(results);
+	free(listNames);
+	free(listChars);
+	free_file_state(&state);
 
-		/* resetting data image */
-		if (dataImage != NULL)
-			free(dataImage);
-		dataImage = NULL;
+	/* the exit status reflects all of the files */
+	return (failed == 0) ? SUCCESS : QUIT_UPON_ERROR;
+}
 
-		/* resetting code image */
-		reset_arr(codeImage, sizeof(codeImage));
+/* Assembles a single file, with its own code image, data image and tables (whose memory is kept from the previous file).
+   Parameters:
+   - baseName: The file's name, without the .as extension.
+   - isLast: Whether it is the last of the files.
+   - state: The tables the file is assembled with, emptied before it.
+   - stats: Where what the file took is put, or NULL if it is not measured.
+   - resNames: The reserved names index, whose macro names are reset for the file.
+   - options: The command line options.
+   - ocList: Array of opcode structures.
+   - dirList: Array of directive structures.
 
-		free_symbol_list(head);
-		head = NULL;
+   Returns:
+   - 1 (FILE_ASSEMBLED) if the file was assembled with no errors.
+   - 2 (FILE_RESTORED) if the file's outputs were restored from the cache, without assembling it.
+   - 0 (FILE_FAILED) otherwise.
 
-		free_need_label_list(nlHead);
-		nlHead = NULL;
+   Notes:
+   - With a cache, a file that was assembled with no errors has its outputs stored in it.
+   - The source is read once, for its cache key and for the pre-processor.
+*/
+int assemble_file(char *baseName, int isLast, fileState *state, fileStats *stats, resNamesIndex *resNames, asmOptions *options, Opcodes ocList[], Directives dirList[])
+{
+	/* ___Declarations___ */
+	/* the source, taken into memory whole */
+	sourceFile source = {NULL, 0, 0, FALSE};
 
-		remove(resNames);
+	/* the file's cache key, if there is a cache */
+	char key[CACHE_KEY_LENGTH + 1];
 
-		if (woExtension != NULL)
-                        free(woExtension);
+	int sourceRes,
+		ppRes,
+		fpRes,
+		spRes,
+		res,
+		cached = FALSE,
+		outputs = 0;
+
+	errStage asmStage;
+	const errStage *stage = &asmStage;
+
+	/* the starting points of the file and of its current stage, for -stats */
+	stageTime fileClock,
+		stageClock;
+
+	start_file_stats(stats, &fileClock);
+
+	/* the tables of the previous file are emptied, and the macro names of the previous file are no longer reserved */
+	reset_file_state(state);
+	name_set_clear(&resNames->mcrs);
+
+	/* the file's errors are kept, and written at once when it is done */
+	asmStage.name = "assembler";
+	asmStage.diags = &state->diags;
+	asmStage.io = (stats != NULL) ? &stats->io : NULL;
+
+	if (!options->compact)
+	{
+		SEPERATOR
+		/* if the given argument is a file path, we'll only print the file's name */
+		if (strrchr(baseName, '/') != NULL)
+			printf("Now processing \"%s.as\":\n", strrchr(baseName, '/') + 1);
+		else
+			printf("Now processing \"%s.as\":\n", baseName);
+	}
+
+	/* ___Reading the source, which is timed as part of the pre-processing___ */
+	start_clock(stats, &stageClock);
+	sourceRes = load_source(&state->diags, baseName, options->fromStdin, &source, asmStage.io);
+	stop_clock(stats, statsStage_pp, &stageClock);
+
+	/* ___A file that is in the cache is not assembled again___ */
+	if (sourceRes == TRUE && options->cacheDir != NULL && !options->fromStdin)
+	{
+		source_key(&source, options->writeAm | (options->binaryOb << 1), key);
+		cached = TRUE;
+	}
+
+	if (cached && restore_cached(stage, options->cacheDir, key, source.size, baseName, &outputs) == TRUE)
+	{
+		res = FILE_RESTORED;
+		if (!options->compact)
+			announce_outputs(outputs);
+	}
+	else
+	{
+		outputs = 0;
+		start_clock(stats, &stageClock);
+		ppRes = (sourceRes == TRUE) ? pre_process(&state->diags, baseName, &source, resNames, &state->names, &state->amLines, options->writeAm,
+												  &outputs, cached ? state->kept : NULL, asmStage.io)
+									: QUIT_UPON_ERROR;
+		stop_clock(stats, statsStage_pp, &stageClock);
+		if (ppRes == QUIT_UPON_ERROR)
+		{
+			close_source(&source);
+			remove_outputs(stage, baseName);
+			flush_diagnostics(baseName, state, options);
+			finish_file_stats(stats, &fileClock);
+			if (options->compact)
+				printf("%s.as: failed\n", baseName);
+			return FILE_FAILED;
+		}
+		if (!options->compact)
+			announce_outputs(outputs);
+
+		start_clock(stats, &stageClock);
+		fpRes = first_pass(&state->diags, baseName, &state->amLines, resNames, state->codeImage, &state->data, ocList, dirList, &state->symbols, &state->fixups);
+		stop_clock(stats, statsStage_fp, &stageClock);
+
+		start_clock(stats, &stageClock);
+		spRes = second_pass(&state->diags, baseName, resNames, state->codeImage, &state->data, ocList, dirList, &state->symbols, &state->fixups,
+							!((ppRes < 0) || (fpRes < 0)), options->binaryOb, fpRes, &outputs, cached ? state->kept : NULL, asmStage.io);
+		stop_clock(stats, statsStage_sp, &stageClock);
+		flush_diagnostics(baseName, state, options);
+		if (!options->compact)
+			announce_outputs(outputs & ~OUTPUT_AM);
+
+		res = (spRes == SUCCESS) ? FILE_ASSEMBLED : FILE_FAILED;
+		if (res == FILE_FAILED)
+			remove_outputs(stage, baseName);
+		if (res == FILE_ASSEMBLED && cached)
+			store_cached(stage, options->cacheDir, key, source.size, baseName, outputs, state->kept);
+	}
+	close_source(&source);
+	flush_diagnostics(baseName, state, options);
+	finish_file_stats(stats, &fileClock);
+
+	/* ___Only a file that failed is reported in the compact form___ */
+	if (options->compact)
+	{
+		if (res == FILE_FAILED)
+			printf("%s.as: failed\n", baseName);
+		return res;
+	}
+
+	if (res != FILE_FAILED)
+		printf("\nThe file was successfully processed with no errors detected.\n");
+	else
+		printf("\nThe file processing is finished, please review the listed errors.\n");
+
+	if (!isLast)
+		printf("Moving to the next file.\n");
+	else
+	{	SEPERATOR
+		printf("\nDone processing for all files.\n");
 	}
 
-	return spRes;
+	printf("\n");
+	return res;
+}
+
+/* Assembles one of the files of the command line, for the worker pool or in order.
+   Parameters:
+   - job: The index of the file.
+   - context: The asmContext.
+
+   Returns:
+   - The fileResult of the file.
+*/
+int assemble_job(int job, void *context)
+{
+	asmContext *files = (asmContext *)context;
+
+	return assemble_file(files->files[job], job == files->fileCount - 1, files->state, (files->stats != NULL) ? &files->stats[job] : NULL,
+						 files->resNames, files->options, files->ocList, files->dirList);
 }
 
 /* ___Helper functions___ */
 
-/* A function that builds a file containing reserved names based on opcode and directive lists.
+/* Reads the command line options, which are given before the files.
    Parameters:
    - stage: The stage in which the error occurred.
-   - resNames: The filename to create and write the reserved names to.
-   - ocList: Array of opcode structures.
-   - dirList: Array of directive structures.
+   - argc, argv: The command line arguments.
+   - options: The options to set.
 
    Returns:
-   - Pointer to the file stream if the file was successfully created and written.
-   - NULL if there was an error during file creation.
+   - The index of the first file in argv.
+   - -1 (FUNC_ERROR) if an option was not recognized, or its value is not valid.
+
+   Notes:
+   - A limit of 0 (to -max-errors or -j) means no limit.
 */
-FILE *build_res_names(const char *stage, char *resNames, Opcodes ocList[], Directives dirList[])
+int parse_options(const errStage *stage, int argc, char *argv[], asmOptions *options)
 {
 	int index;
-	FILE *fileP;
 
-	if ((fileP = fopen(resNames, "w")) == NULL)
+	for (index = 1; index < argc && argv[index][0] == '-'; index++)
+	{
+		if (strcmp(argv[index], OPT_WRITE_AM) == 0)
+			options->writeAm = TRUE;
+		else if (strcmp(argv[index], OPT_BINARY_OB) == 0)
+			options->binaryOb = TRUE;
+		else if (strcmp(argv[index], OPT_STDIN) == 0)
+			options->fromStdin = TRUE;
+		else if (strcmp(argv[index], OPT_CACHE) == 0 && index + 1 < argc)
+			options->cacheDir = argv[++index];
+		else if (strcmp(argv[index], OPT_LIST) == 0 && index + 1 < argc)
+		{
+			options->listName = argv[++index];
+			options->compact = TRUE;
+		}
+		else if (strcmp(argv[index], OPT_NUL_SEPARATED) == 0)
+			options->nulSeparated = TRUE;
+		else if (strcmp(argv[index], OPT_JSON) == 0)
+			options->json = TRUE;
+		else if (strcmp(argv[index], OPT_STATS) == 0)
+			options->stats = TRUE;
+		else if (strcmp(argv[index], OPT_MAX_ERRORS) == 0 || strcmp(argv[index], OPT_JOBS) == 0)
+		{
+			if (index + 1 == argc || parse_count(argv[index + 1], (strcmp(argv[index], OPT_JOBS) == 0) ? &options->jobs : &options->maxErrors) != TRUE)
+			{
+				err_wo_line(stage, asmblrErrList[ASMBLR_ERR_OPTION_VALUE], argv[index]);
+				return FUNC_ERROR;
+			}
+			if (strcmp(argv[index], OPT_JOBS) == 0 && options->jobs == 0)
+				options->jobs = MAX_WORKERS;
+			index++;
+		}
+		else
+		{
+			err_wo_line(stage, asmblrErrList[ASMBLR_ERR_UNKNOWN_OPTION], argv[index]);
+			return FUNC_ERROR;
+		}
+	}
+	return index;
+}
+
+/* Reads the value of an option that counts something.
+   Parameters:
+   - text: The value, as it was given.
+   - count: Where the number is put.
+
+   Returns:
+   - 1 (TRUE) if the value is a number of 0 or more.
+   - 0 (FALSE) otherwise, and count is not changed.
+*/
+int parse_count(const char *text, int *count)
+{
+	char *end;
+	long value = strtol(text, &end, 10);
+
+	if (end == text || *end != '\0' || value < 0 || value > INT_MAX)
+		return FALSE;
+
+	*count = (int)value;
+	return TRUE;
+}
+
+/* Reads the names of the files from a list, which is a file or the standard input.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - options: The command line options, with the list's name and how its names are separated.
+   - chars: Where the characters of the names are put - the names point into them, and they should be freed.
+   - count: Where the number of names is put.
+
+   Returns:
+   - The names, which should be freed.
+   - NULL if the list could not be read, or there was an error during memory allocation.
+
+   Notes:
+   - Empty names are skipped, and a newline separated name may end with a carriage return.
+*/
+char **read_file_list(const errStage *stage, asmOptions *options, char **chars, int *count)
+{
+	sourceFile list = {NULL, 0, 0, FALSE};
+
+	char **names = NULL,
+		 separator = options->nulSeparated ? '\0' : '\n';
+
+	long pos,
+		start,
+		end,
+		size;
+
+	int capacity = 1;
+
+	if ((strcmp(options->listName, LIST_STDIN) == 0 ? read_stdin(&list) : open_source(options->listName, &list)) == FUNC_ERROR)
 	{
-		err_wo_line(stage, asmblrErrList[ASMBLR_ERR_FILE_CREATION], resNames);
+		err_wo_line(stage, asmblrErrList[ASMBLR_ERR_LIST], options->listName);
 		return NULL;
 	}
-	for (index = FIRST_REG_NUM; index <= LAST_REG_NUM; index++)
+
+	/* ___The names are copied, so each can be null terminated in place___ */
+	for (pos = 0; pos < list.size; pos++)
 	{
-		fprintf(fileP, "r%d\n", index);
+		if (list.chars[pos] == separator)
+			capacity++;
 	}
-	for (index = 0; index < Element_instructionEnd; index++)
+	if ((*chars = (char *)malloc(list.size + 1)) == NULL ||
+		(names = (char **)malloc(capacity * sizeof(char *))) == NULL)
 	{
-		fprintf(fileP, "%s\n", ocList[index].name);
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		free(*chars);
+		*chars = NULL;
+		close_source(&list);
+		return NULL;
 	}
-	for (index = 0; index < (Element_directiveEnd - 1 - Element_instructionEnd); index++)
+	if ((size = list.size) > 0)
+		memcpy(*chars, list.chars, size);
+	close_source(&list);
+
+	/* ___Splitting the names___ */
+	*count = 0;
+	for (pos = 0, start = 0; pos <= size; pos++)
 	{
-		fprintf(fileP, "%s\n", dirList[index].name);
+		if (pos < size && (*chars)[pos] != separator)
+			continue;
+
+		end = pos;
+		if (!options->nulSeparated && end > start && (*chars)[end - 1] == '\r')
+			end--;
+		(*chars)[end] = '\0';
+
+		if (end > start)
+			names[(*count)++] = *chars + start;
+		start = pos + 1;
 	}
-	return fileP;
+	return names;
 }
 
-/* Resets an array by replacing all elements with a placeholder value.
-Parameters:
-- arr: The array to be reset.
-- arrSize: The size of the array.
-
-Notes:
-- Replaces all elements in the array with the placeholder value.
-- Will be used to reset the codeImage array between files.
+/* Prints a line for every output file that was written, in the order they are written.
+   Parameters:
+   - outputs: The output files, as outputFile flags.
 */
-void reset_arr(short int arr[], int arrSize)
+void announce_outputs(int outputs)
 {
-	int index = 0;
+	int index;
 
-	for (index = 0; index < arrSize; index++)
+	for (index = 0; index < OUTPUT_KINDS; index++)
 	{
-		if (arr[index] == PLACEHOLDER)
-			return;
-
-		arr[index] = PLACEHOLDER;
+		if (outputs & outputKinds[index].flag)
+			printf("%s\n", outputKinds[index].message);
 	}
 }
 
-/* Frees memory allocated for a linked list of needLabelNode structures.
-Parameters:
-- head: Pointer to the head of the needLabelNode list.
-
-Notes:
-- Frees memory for each node in the linked list starting from the head.
+/* Empties the tables of the previous file, keeping their memory.
+   Parameters:
+   - state: The tables.
 */
-void free_need_label_list(needLabelNode *head)
+void reset_file_state(fileState *state)
 {
-	needLabelNode *current = head,
-				  *nextNode;
+	memset(state->codeImage, 0, sizeof(state->codeImage));
+	state->codeImage[0] = PLACEHOLDER;
+
+	state->data.count = 0;
+	state->fixups.count = 0;
+	clear_string_pool(&state->names);
+	clear_symbol_table(&state->symbols);
+	clear_line_buffer(&state->amLines);
+	clear_diag_list(&state->diags);
+}
 
-	if (head == NULL)
-		return;
+/* Frees the memory of the tables, leaving them empty.
+   Parameters:
+   - state: The tables.
+*/
+void free_file_state(fileState *state)
+{
+	int index;
 
-	while (current->next != NULL)
-	{
-		nextNode = current->next; /* save the next pointer */
-		free(current);			  /* free the current node */
-		current = nextNode;		  /* move to the next node */
-	}
-	free(current);
+	free_data_buffer(&state->data);
+	free_symbol_table(&state->symbols);
+	free_fixup_table(&state->fixups);
+	free_string_pool(&state->names);
+	free_line_buffer(&state->amLines);
+	free_diag_list(&state->diags);
+	for (index = 0; index < OUTPUT_KINDS; index++)
+		free_output_buffer(&state->kept[index]);
 }
 
-/* Frees memory allocated for a linked list of symbolNode structures.
-Parameters:
-- head: Pointer to the head of the symbolNode list.
-
-Notes:
-- Frees memory for each node in the linked list starting from the head.
+/* Writes the errors a file has so far, and empties the list for the errors after them.
+   Parameters:
+   - baseName: The file's name, without the .as extension.
+   - state: The file's tables, with its errors.
+   - options: The command line options - whether the errors are written as JSON lines.
 */
-void free_symbol_list(symbolNode *head)
+void flush_diagnostics(char *baseName, fileState *state, asmOptions *options)
 {
-	symbolNode *current = head,
-			   *nextNode;
+	char *ipName;
 
-	if (head == NULL)
+	if (state->diags.count == 0 && state->diags.dropped == 0)
 		return;
 
-	while (current->next != NULL)
-	{
-		nextNode = current->next; /* save the next pointer */
-		free(current);			  /* free the current node */
-		current = nextNode;		  /* move to the next node */
-	}
-	free(current);
+	/* the lines printed before the errors are written first, for when both go to the same file */
+	fflush(stdout);
+
+	/* the JSON lines name the source, the text names the file of every error */
+	ipName = add_ext(baseName, ".as");
+	write_diagnostics(stderr, &state->diags, (ipName != NULL) ? ipName : baseName, options->json);
+	free(ipName);
+
+	clear_diag_list(&state->diags);
 }
+
+/*___Error list___ */
+const char *asmblrErrList[] =
+{
+	"No source files were given as arguments",
+	"Could not build the reserved names index",
+	"Unrecognized command line option (usage: assembler [-am] [-bin] [-stdin] [-j <jobs>] [-cache <dir>] [-max-errors <n>] [-json] [-stats] <files> or -list <file> [-0], assembler -serve <socket> [-j <workers>], or assembler -connect <socket> <arguments>)",
+	"Only one file can be read from the standard input",
+	"Could not read the list of files",
+	"Files cannot be given along with a list, or read from the standard input",
+	"The following option needs a number of 0 or more (0 for no limit)"
+};
+
+/* the names of the fileResults, for the -stats report */
+const char *fileResultNames[] =
+{
+	"failed",
+	"assembled",
+	"cached"
+};
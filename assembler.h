@@ -3,10 +3,27 @@
 #define ASSEMBLER_H
 
 /* ___Include___ */
-#include "general_lib.h"
+#include "libassembler.h"
+#include "worker_pool.h"
+#include "server.h"
+#include "cache.h"
+#include "stats.h"
 
 /* ___Definitions___ */
 #define MIN_ARGS 2
+#define OPT_WRITE_AM "-am"
+#define OPT_BINARY_OB "-bin"
+#define OPT_JOBS "-j"
+#define OPT_STDIN "-stdin"
+#define OPT_CACHE "-cache"
+#define OPT_LIST "-list"
+#define OPT_NUL_SEPARATED "-0"
+#define OPT_MAX_ERRORS "-max-errors"
+#define OPT_JSON "-json"
+#define OPT_STATS "-stats"
+#define LIST_STDIN "-" /* the list is read from the standard input */
+#define OPT_SERVE "-serve"
+#define OPT_CONNECT "-connect"
 #define SEPERATOR printf("================================================================================\n");
 
 
@@ -14,56 +31,81 @@
 /* Enum defining error indices related to the assembling stage. */
 enum asmblrErrIndex
 {
-	ASMBLR_ERR_MISSING_ARGS, /* Missing command line arguments */
-	ASMBLR_ERR_FILE_CREATION /* Failed to create a file */
+	ASMBLR_ERR_MISSING_ARGS,   /* Missing command line arguments */
+	ASMBLR_ERR_RES_NAMES,	   /* Failed to build the reserved names index */
+	ASMBLR_ERR_UNKNOWN_OPTION, /* Unrecognized command line option */
+	ASMBLR_ERR_STDIN_FILES,	   /* More than one file with the -stdin option */
+	ASMBLR_ERR_LIST,		   /* Could not read the list of files */
+	ASMBLR_ERR_LIST_FILES,	   /* Files were given along with a list */
+	ASMBLR_ERR_OPTION_VALUE	   /* An option's value is not a number of 0 or more */
 };
 
-/* ___Macro definitions for lists___ */
-#define OC_LIST_DEC 									\
-/* name, index, label, op, source addressing, destination adressing */ \
-	Opcodes ocList[] = {								\
-		{"mov", Element_mov, TRUE, 2, "1111", "0111"},	\
-		{"cmp", Element_cmp, TRUE, 2, "1111", "1111"},	\
-		{"add", Element_add, TRUE, 2, "1111", "0111"},	\
-		{"sub", Element_sub, TRUE, 2, "1111", "0111"},	\
-		{"not", Element_not, TRUE, 1, "0000", "0111"},	\
-		{"clr", Element_clr, TRUE, 1, "0000", "0111"},	\
-		{"lea", Element_lea, TRUE, 2, "0110", "0111"},	\
-		{"inc", Element_inc, TRUE, 1, "0000", "0111"},	\
-		{"dec", Element_dec, TRUE, 1, "0000", "0111"},	\
-		{"jmp", Element_jmp, TRUE, 1, "0000", "0101"},	\
-		{"bne", Element_bne, TRUE, 1, "0000", "0101"},	\
-		{"red", Element_red, TRUE, 1, "0000", "0111"},	\
-		{"prn", Element_prn, TRUE, 1, "0000", "1111"},	\
-		{"jsr", Element_jsr, TRUE, 1, "0000", "0101"},	\
-		{"rts", Element_rts, TRUE, 0, "0000", "0000"},	\
-		{"hlt", Element_hlt, TRUE, 0, "0000", "0000"}};
+/* Enum defining what became of a file - the result of its job */
+enum fileResult
+{
+	FILE_FAILED,	/* errors were found in the file */
+	FILE_ASSEMBLED, /* the file was assembled with no errors */
+	FILE_RESTORED	/* the file's outputs were restored from the cache */
+};
 
-#define DIR_LIST_DEC 									\
-	/* name, index, label */							\
-	Directives dirList[] = {							\
-		{".data", Element_data, TRUE},					\
-		{".string", Element_string, TRUE},				\
-		{".entry", Element_entry, FALSE},				\
-		{".extern", Element_extern, FALSE},				\
-		{".define", Element_define, FALSE}};
+/* ___Constants___ */
+extern const char *asmblrErrList[];
+extern const char *fileResultNames[];
 
-/*___Error list___ */
-char *asmblrErrList[] =
+/* ___Typedef___ */
+/* command line options, given before the files */
+typedef struct asmOptions
 {
-	"No source files were given as arguments",
-	"Could not create the following file"
-};
+	int writeAm,  /* keep the macro-expanded source as a .am file */
+		binaryOb, /* write a binary .obj file instead of the .ob, .ent and .ext files */
+		jobs,	  /* the number of files that are assembled at a time (-j 0 sets MAX_WORKERS, the most there can be) */
+		fromStdin; /* the source of the file is read from the standard input */
+	char *cacheDir; /* where the outputs of assembled files are kept, or NULL */
+	char *listName; /* the list the files' names are read from, or NULL */
+	int nulSeparated, /* the names in the list are separated by null characters, instead of newlines */
+		compact,	  /* a line is printed only for a file that failed, instead of the full report */
+		maxErrors,	  /* the number of errors after which a file is not checked further, 0 for no limit */
+		json,		  /* the errors are written as JSON lines */
+		stats;		  /* what every file took is printed at the end */
+} asmOptions;
+
+/* the tables a file is assembled with - emptied between files, so their memory is reused */
+typedef struct fileState
+{
+	short int codeImage[RAM_SIZE];
+	dataBuffer data;
+	stringPool names;
+	symbolTable symbols;
+	fixupTable fixups;
+	lineBuffer amLines;
+	diagList diags; /* the file's errors, written at once when it is done */
+	outputBuffer kept[OUTPUT_KINDS]; /* the contents of the output files that were written, for the output cache */
+} fileState;
+
+/* the files of the command line, and what each of them is assembled with */
+typedef struct asmContext
+{
+	char **files; /* the files' names, without the .as extension */
+	int fileCount;
+	resNamesIndex *resNames;
+	asmOptions *options;
+	Opcodes *ocList;
+	Directives *dirList;
+	fileState *state;
+	fileStats *stats;		/* the statistics of every file, or NULL if they are not kept */
+	stageTime resNamesTime; /* the time the reserved names index took to build */
+} asmContext;
 
 /* ___Prototypes___*/
-FILE *build_res_names(const char *stage, char *resNames, Opcodes ocList[], Directives dirList[]);
-int pre_process(char *baseName, char *resNames);
-int first_pass(char *baseName, char *resNames, short int codeImage[], short int **dataImage,
-			   Opcodes ocList[], Directives dirList[], symbolNode **symbolHead, needLabelNode **needLHead);
-int second_pass(char *baseName, char *resNames, short int codeImage[], short int *dataImage,
-				Opcodes ocList[], Directives dirList[], symbolNode **symbolHead, needLabelNode **needLHead, int makeOutput, int IC);
-void reset_arr(short int arr[], int arrSize);
-void free_need_label_list(needLabelNode *head);
-void free_symbol_list(symbolNode *head);
+int parse_options(const errStage *stage, int argc, char *argv[], asmOptions *options);
+int parse_count(const char *text, int *count);
+int assemble_request(int argc, char *argv[], void *context);
+int assemble_file(char *baseName, int isLast, fileState *state, fileStats *stats, resNamesIndex *resNames, asmOptions *options, Opcodes ocList[], Directives dirList[]);
+int assemble_job(int job, void *context);
+char **read_file_list(const errStage *stage, asmOptions *options, char **chars, int *count);
+void announce_outputs(int outputs);
+void reset_file_state(fileState *state);
+void free_file_state(fileState *state);
+void flush_diagnostics(char *baseName, fileState *state, asmOptions *options);
 
 #endif
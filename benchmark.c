@@ -0,0 +1,615 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "benchmark.h"
+#include "pre_process.h"
+#include "second_pass.h"
+
+#include <stdarg.h>
+#include <time.h>
+
+/* ___The benchmark___ */
+/* Sources of growing sizes are generated, and assembled stage by stage in memory, with the assembler's library.
+   The lines and the words every stage goes through in a second are printed for every size,
+   so a stage whose time grows faster than its input shows as a falling rate.
+   The sample's outputs are checked first, so a faster assembler that is no longer correct is not measured. */
+
+int main(int argc, char *argv[])
+{
+	/* ___Declarations___ */
+	asmSession session;
+
+	sourceMix mix = {8, 2, 10, 6, 4, 4};
+
+	outputBuffer src = {NULL, 0, 0};
+
+	stageRun run,
+		best;
+
+	long sizes[MAX_SIZES] = {1000L, 10000L, 100000L, 1000000L};
+
+	int sizeCount = 4,
+		runs = DEFAULT_RUNS,
+		sizeIndex,
+		runIndex,
+		full = FALSE,
+		anyFull = FALSE,
+		res = SUCCESS;
+
+	char *writeName = NULL,
+		 fileName[BENCH_NAME_LENGTH + MAX_LINE_LENGTH];
+
+	/* errors are printed to stderr */
+	const errStage benchStage = {"benchmark", NULL},
+				   *stage = &benchStage;
+
+	if (parse_bench_options(argc, argv, &mix, sizes, &sizeCount, &runs, &writeName) == FUNC_ERROR)
+	{
+		err_wo_line(stage, benchErrList[BENCH_ERR_USAGE], NULL);
+		return QUIT_UPON_ERROR;
+	}
+
+	if (asm_session_init(&session) != SUCCESS)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return QUIT_UPON_ERROR;
+	}
+
+	if (check_sample(stage, &session) != TRUE)
+	{
+		asm_session_free(&session);
+		return QUIT_UPON_ERROR;
+	}
+	printf("The outputs of \"%s.as\" are the expected ones.\n\n", SAMPLE_NAME);
+	printf("%8s %8s  %-15s %10s %12s %12s %8s\n", "lines", "words", "stage", "seconds", "lines/sec", "words/sec", "ns/line");
+
+	/* ___Measuring every size, the best of its runs___ */
+	for (sizeIndex = 0; sizeIndex < sizeCount && res == SUCCESS; sizeIndex++)
+	{
+		src.size = 0;
+		if (gen_source(&mix, sizes[sizeIndex], &src, &full) == FUNC_ERROR)
+		{
+			sprintf(fileName, "%ld", sizes[sizeIndex]);
+			err_wo_line(stage, benchErrList[BENCH_ERR_SOURCE], fileName);
+			res = QUIT_UPON_ERROR;
+			break;
+		}
+		if (full)
+			anyFull = TRUE;
+
+		/* the source can be written, to be assembled with the assembler itself */
+		if (writeName != NULL)
+		{
+			sprintf(fileName, "%.*s%ld.as", BENCH_NAME_LENGTH, writeName, sizes[sizeIndex]);
+			if (write_output(stage, fileName, &src) == FUNC_ERROR)
+			{
+				res = QUIT_UPON_ERROR;
+				break;
+			}
+		}
+
+		for (runIndex = 0; runIndex < runs; runIndex++)
+		{
+			if (run_stages(&session, BENCH_NAME, src.chars, src.size, &run) != TRUE)
+			{
+				sprintf(fileName, "%ld", sizes[sizeIndex]);
+				err_wo_line(stage, benchErrList[BENCH_ERR_SOURCE], fileName);
+				free_stage_run(&run);
+				if (runIndex > 0)
+					free_stage_run(&best);
+				res = QUIT_UPON_ERROR;
+				break;
+			}
+
+			if (runIndex == 0 || run.seconds[benchStage_pp] + run.seconds[benchStage_fp] + run.seconds[benchStage_sp] <
+									 best.seconds[benchStage_pp] + best.seconds[benchStage_fp] + best.seconds[benchStage_sp])
+			{
+				if (runIndex > 0)
+					free_stage_run(&best);
+				best = run;
+			}
+			else
+				free_stage_run(&run);
+		}
+
+		if (res == SUCCESS)
+		{
+			print_stages(sizes[sizeIndex], &best);
+			free_stage_run(&best);
+		}
+	}
+
+	if (anyFull)
+		printf("\nThe memory holds %d words - once they are taken, the rest of a source is .define, .extern and macro definition lines.\n", IMAGE_WORDS);
+
+	free_output_buffer(&src);
+	asm_session_free(&session);
+	return res;
+}
+
+/* ___Helper functions___ */
+
+/* Reads the command line options.
+   Parameters:
+   - argc, argv: The command line arguments.
+   - mix: Set to the mix of the generated sources, for the options that were given.
+   - sizes, sizeCount: Set to the sizes to measure, if they were given.
+   - runs: Set to the number of runs of every size, if it was given.
+   - writeName: Set to the name the sources are written under, if it was given.
+
+   Returns:
+   - 1 (TRUE) if the options are valid.
+   - -1 (FUNC_ERROR) if they are not.
+*/
+int parse_bench_options(int argc, char *argv[], sourceMix *mix, long sizes[], int *sizeCount, int *runs, char **writeName)
+{
+	const char *names[] = {OPT_LABELS, OPT_MACROS, OPT_DEFINES, OPT_DATA, OPT_EXTERNS, OPT_INDEXES, OPT_RUNS};
+
+	int *counts[COUNT_OPTIONS];
+
+	int index,
+		count;
+
+	long value;
+
+	char *end;
+
+	counts[0] = &mix->labels;
+	counts[1] = &mix->macros;
+	counts[2] = &mix->defines;
+	counts[3] = &mix->data;
+	counts[4] = &mix->externs;
+	counts[5] = &mix->indexes;
+	counts[6] = runs;
+
+	for (index = 1; index < argc; index++)
+	{
+		if (index + 1 >= argc)
+			return FUNC_ERROR;
+
+		if (strcmp(argv[index], OPT_SIZES) == 0)
+		{
+			if (parse_sizes(argv[++index], sizes, sizeCount) == FUNC_ERROR)
+				return FUNC_ERROR;
+			continue;
+		}
+		if (strcmp(argv[index], OPT_WRITE) == 0)
+		{
+			*writeName = argv[++index];
+			continue;
+		}
+
+		for (count = 0; count < COUNT_OPTIONS && strcmp(argv[index], names[count]) != 0; count++)
+			;
+		if (count == COUNT_OPTIONS)
+			return FUNC_ERROR;
+
+		value = strtol(argv[++index], &end, 10);
+		if (*end != '\0' || value < 0 || value > MAX_DIR_NUM || (counts[count] == runs && value == 0))
+			return FUNC_ERROR;
+		*counts[count] = (int)value;
+	}
+
+	/* a constant index operand refers to a .data label of its block */
+	return (mix->indexes > 0 && mix->data == 0) ? FUNC_ERROR : TRUE;
+}
+
+/* Reads a list of sizes, separated by commas.
+   Parameters:
+   - list: The list.
+   - sizes: Where the sizes are put (at most MAX_SIZES).
+   - sizeCount: Set to the number of sizes.
+
+   Returns:
+   - 1 (TRUE) if the list is valid.
+   - -1 (FUNC_ERROR) if it is not.
+*/
+int parse_sizes(char *list, long sizes[], int *sizeCount)
+{
+	char *end;
+
+	*sizeCount = 0;
+	while (*sizeCount < MAX_SIZES)
+	{
+		sizes[*sizeCount] = strtol(list, &end, 10);
+		if (end == list || sizes[*sizeCount] <= 0)
+			return FUNC_ERROR;
+		(*sizeCount)++;
+
+		if (*end == '\0')
+			return TRUE;
+		if (*end != ',')
+			return FUNC_ERROR;
+		list = end + 1;
+	}
+	return FUNC_ERROR;
+}
+
+/* Adds a line to a generated source.
+   Parameters:
+   - gen: The source.
+   - format: The line, as a printf format, without its newline.
+
+   Returns:
+   - 1 (TRUE) if the line was added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int gen_line(sourceGen *gen, const char *format, ...)
+{
+	va_list args;
+
+	if (reserve_output(gen->src, MAX_LINE_LENGTH + 1) == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	va_start(args, format);
+	gen->src->size += vsprintf(gen->src->chars + gen->src->size, format, args);
+	va_end(args);
+
+	gen->src->chars[gen->src->size++] = '\n';
+	gen->lines++;
+	return TRUE;
+}
+
+/* Counts the words of a block's code and data.
+   Parameters:
+   - mix: The mix of the block.
+
+   Returns:
+   - The number of words.
+*/
+int block_words(const sourceMix *mix)
+{
+	return mix->labels * LABEL_WORDS + mix->macros * MCR_WORDS + mix->externs * EXTERN_REF_WORDS +
+		   mix->indexes * INDEX_WORDS + (mix->data + 1) / 2 * DATA_WORDS + mix->data / 2 * STRING_WORDS;
+}
+
+/* Adds a block to a generated source - its definitions, then its data and code, if they still fit in the memory.
+   Parameters:
+   - gen: The source.
+   - mix: The mix of the block.
+
+   Returns:
+   - 1 (TRUE) if the block was added.
+   - 0 (FALSE) if there are fewer lines left than the block has.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+
+   Notes:
+   - Every name is used after it is defined, and a label only jumps back, so a source that ends after any block is valid.
+*/
+int gen_block(sourceGen *gen, const sourceMix *mix)
+{
+	int index,
+		line,
+		res = TRUE,
+		firstDefine = gen->defines,
+		firstExtern = gen->externs,
+		firstMacro = gen->macros,
+		firstData = gen->data;
+
+	long lines = mix->defines + mix->externs + (long)mix->macros * (MCR_BODY_LINES + 2);
+
+	if (!gen->full && gen->words + block_words(mix) > IMAGE_WORDS)
+		gen->full = TRUE;
+	if (!gen->full)
+		lines += mix->data + mix->labels + mix->externs + mix->indexes + mix->macros;
+
+	if (lines == 0 || lines > gen->target - gen->lines)
+		return FALSE;
+
+	/* ___The definitions___ */
+	for (index = 0; index < mix->defines && res == TRUE; index++, gen->defines++)
+		res = gen_line(gen, ".define d%d = %d", gen->defines, index % 4);
+
+	for (index = 0; index < mix->externs && res == TRUE; index++, gen->externs++)
+		res = gen_line(gen, ".extern x%d", gen->externs);
+
+	for (index = 0; index < mix->macros && res == TRUE; index++, gen->macros++)
+	{
+		res = gen_line(gen, "mcr m%d", gen->macros);
+		for (line = 0; line < MCR_BODY_LINES && res == TRUE; line++)
+		{
+			if (line == 0)
+				res = gen_line(gen, "\tinc r%d", index % 8);
+			else if (line == 1)
+				res = gen_line(gen, "\tprn #%d", index);
+			else
+				res = gen_line(gen, "\tsub r1, r2");
+		}
+		if (res == TRUE)
+			res = gen_line(gen, "endmcr");
+	}
+
+	if (gen->full)
+		return res;
+
+	/* ___The data, and the code that uses everything the block defined___ */
+	for (index = 0; index < mix->data && res == TRUE; index++, gen->data++)
+	{
+		if (index % 2 == 0)
+			res = gen_line(gen, "v%d: .data %d, -%d, %d", gen->data, index, index + 1, index + 2);
+		else
+			res = gen_line(gen, "s%d: .string \"abcd\"", gen->data);
+	}
+
+	for (index = 0; index < mix->labels && res == TRUE; index++, gen->labels++)
+		res = gen_line(gen, "l%d: bne l%d", gen->labels, gen->labels - gen->labels % 4);
+
+	for (index = 0; index < mix->externs && res == TRUE; index++)
+		res = gen_line(gen, "\tjsr x%d", firstExtern + index);
+
+	for (index = 0; index < mix->indexes && res == TRUE; index++)
+	{
+		if (mix->defines > 0)
+			res = gen_line(gen, "\tmov v%d[d%d], r%d", firstData, firstDefine + index % mix->defines, index % 8);
+		else
+			res = gen_line(gen, "\tmov v%d[%d], r%d", firstData, index % 3, index % 8);
+	}
+
+	for (index = 0; index < mix->macros && res == TRUE; index++)
+		res = gen_line(gen, "m%d", firstMacro + index);
+
+	gen->words += block_words(mix);
+	return res;
+}
+
+/* Generates a valid source.
+   Parameters:
+   - mix: The mix of its blocks.
+   - lines: The number of lines.
+   - src: Where the source is put.
+   - full: Set if the memory was full before the source ended.
+
+   Returns:
+   - 1 (TRUE) if the source was generated.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+
+   Notes:
+   - The lines after the last block that fits are .define lines.
+*/
+int gen_source(const sourceMix *mix, long lines, outputBuffer *src, int *full)
+{
+	sourceGen gen = {NULL, 0, 0, 0, FALSE, 0, 0, 0, 0, 0};
+
+	int res;
+
+	gen.src = src;
+	gen.target = lines;
+
+	while ((res = gen_block(&gen, mix)) == TRUE)
+		;
+
+	while (res != FUNC_ERROR && gen.lines < gen.target)
+		res = gen_line(&gen, ".define d%d = %d", gen.defines++, 0);
+
+	*full = gen.full;
+	return (res == FUNC_ERROR) ? FUNC_ERROR : TRUE;
+}
+
+/* Finds the time, for measuring.
+   Returns:
+   - The seconds since an arbitrary point.
+*/
+double now_seconds(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/* Assembles a source in memory, as the assembler's library does, and measures every stage.
+   Parameters:
+   - session: The session.
+   - name: The source's name, for diagnostics.
+   - chars, size: The source.
+   - run: Where the times, the number of words and the output files are put (freed with free_stage_run).
+
+   Returns:
+   - 1 (TRUE) if the source was assembled.
+   - -1 (FUNC_ERROR) if it had errors, which are printed, or there was an error during memory allocation.
+*/
+int run_stages(asmSession *session, char *name, const char *chars, long size, stageRun *run)
+{
+	/* ___Declarations___ */
+	short int codeImage[RAM_SIZE] = {PLACEHOLDER};
+
+	symbolTable symbols = {NULL, 0, 0, NULL, 0, NULL, 0, NULL};
+
+	fixupTable fixups = {NULL, 0, 0};
+
+	lineBuffer amLines = {NULL, 0, 0, NULL, 0, 0};
+
+	stringPool names = {NULL, 0, 0, NULL, 0, 0};
+
+	dataBuffer data = {NULL, 0, 0};
+
+	symbolRefList exts = {NULL, 0, 0},
+				  ents = {NULL, 0, 0};
+
+	diagList diags = {NULL, 0, 0, NULL, 0, 0, 0, 0};
+
+	outputBuffer emptyOut = {NULL, 0, 0};
+
+	sourceFile ip;
+
+	double start;
+
+	int ppRes,
+		fpRes = QUIT_UPON_ERROR,
+		spRes = QUIT_UPON_ERROR,
+		res = TRUE;
+
+	run->ob = run->ent = run->ext = emptyOut;
+	run->seconds[benchStage_pp] = run->seconds[benchStage_fp] = run->seconds[benchStage_sp] = 0;
+	symbols.names = &names;
+
+	ip.chars = (char *)chars;
+	ip.size = size;
+	ip.pos = 0;
+	ip.mapped = FALSE;
+
+	/* the macro names of the previous source are no longer reserved */
+	name_set_clear(&session->resNames.mcrs);
+
+	/* ___The stages___ */
+	start = now_seconds();
+	ppRes = expand_macros(&diags, name, &ip, &session->resNames, &names, &amLines);
+	run->seconds[benchStage_pp] = now_seconds() - start;
+
+	if (ppRes != QUIT_UPON_ERROR)
+	{
+		start = now_seconds();
+		fpRes = first_pass(&diags, name, &amLines, &session->resNames, codeImage, &data,
+						   session->ocList, session->dirList, &symbols, &fixups);
+		run->seconds[benchStage_fp] = now_seconds() - start;
+
+		/* the second pass formats the output files, as the assembler does before it writes them */
+		start = now_seconds();
+		spRes = resolve_labels(&diags, name, codeImage, &symbols, &fixups, &exts);
+		if (ppRes >= 0 && fpRes >= 0 && spRes == SUCCESS &&
+			(collect_entries(&symbols, &ents) == FUNC_ERROR ||
+			 write_symbols(&exts, &run->ext, FALSE) == FUNC_ERROR ||
+			 write_symbols(&ents, &run->ent, FALSE) == FUNC_ERROR ||
+			 write_ob(codeImage, fpRes, &data, &run->ob) == FUNC_ERROR))
+			res = FUNC_ERROR;
+		run->seconds[benchStage_sp] = now_seconds() - start;
+	}
+
+	if (ppRes < 0 || fpRes < 0 || spRes != SUCCESS)
+		res = FUNC_ERROR;
+	if (diags.count > 0)
+		write_diagnostics(stderr, &diags, name, FALSE);
+	run->words = (fpRes >= 0) ? fpRes + data.count : 0;
+
+	LIB_CLOSE
+	free_data_buffer(&data);
+	free_symbol_refs(&exts);
+	free_symbol_refs(&ents);
+	free_string_pool(&names);
+	free_diag_list(&diags);
+	return res;
+}
+
+/* Frees the output files of a run.
+   Parameters:
+   - run: The run.
+*/
+void free_stage_run(stageRun *run)
+{
+	free_output_buffer(&run->ob);
+	free_output_buffer(&run->ent);
+	free_output_buffer(&run->ext);
+}
+
+/* Compares an output file that was formatted in memory with a file.
+   Parameters:
+   - name: The file's name.
+   - out: The output file.
+
+   Returns:
+   - 1 (TRUE) if they are the same - an empty output is the same as a missing file, as the assembler does not write it.
+   - 0 (FALSE) if they are not.
+*/
+int same_output(const char *name, outputBuffer *out)
+{
+	sourceFile expected = {NULL, 0, 0, FALSE};
+
+	int res;
+
+	if (open_source(name, &expected) == FUNC_ERROR)
+		return out->size == 0;
+
+	res = (expected.size == out->size && (out->size == 0 || memcmp(expected.chars, out->chars, out->size) == 0));
+	close_source(&expected);
+	return res;
+}
+
+/* Assembles the sample, and compares its outputs with its expected .ob, .ent and .ext files.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - session: The session.
+
+   Returns:
+   - 1 (TRUE) if the outputs are the expected ones.
+   - -1 (FUNC_ERROR) if the sample could not be read or assembled, or its outputs differ.
+*/
+int check_sample(const errStage *stage, asmSession *session)
+{
+	sourceFile sample = {NULL, 0, 0, FALSE};
+
+	stageRun run;
+
+	int res = TRUE;
+
+	if (open_source(SAMPLE_NAME ".as", &sample) == FUNC_ERROR)
+	{
+		err_wo_line(stage, benchErrList[BENCH_ERR_SAMPLE_READ], SAMPLE_NAME ".as");
+		return FUNC_ERROR;
+	}
+
+	if (run_stages(session, "ps", sample.chars, sample.size, &run) != TRUE)
+	{
+		err_wo_line(stage, benchErrList[BENCH_ERR_SAMPLE_ASSEMBLE], SAMPLE_NAME ".as");
+		res = FUNC_ERROR;
+	}
+	else if (!same_output(SAMPLE_NAME ".ob", &run.ob))
+	{
+		err_wo_line(stage, benchErrList[BENCH_ERR_SAMPLE_DIFF], SAMPLE_NAME ".ob");
+		res = FUNC_ERROR;
+	}
+	else if (!same_output(SAMPLE_NAME ".ent", &run.ent))
+	{
+		err_wo_line(stage, benchErrList[BENCH_ERR_SAMPLE_DIFF], SAMPLE_NAME ".ent");
+		res = FUNC_ERROR;
+	}
+	else if (!same_output(SAMPLE_NAME ".ext", &run.ext))
+	{
+		err_wo_line(stage, benchErrList[BENCH_ERR_SAMPLE_DIFF], SAMPLE_NAME ".ext");
+		res = FUNC_ERROR;
+	}
+
+	free_stage_run(&run);
+	close_source(&sample);
+	return res;
+}
+
+/* Prints the times and the rates of every stage, for a size.
+   Parameters:
+   - lines: The size, in source lines.
+   - run: The best run of the size.
+*/
+void print_stages(long lines, stageRun *run)
+{
+	const char *stageNames[benchStage_end] = {"pre processing", "first pass", "second pass"};
+
+	double seconds,
+		total = run->seconds[benchStage_pp] + run->seconds[benchStage_fp] + run->seconds[benchStage_sp];
+
+	int index;
+
+	/* a row for every stage, and one for all of them */
+	for (index = 0; index <= benchStage_end; index++)
+	{
+		seconds = (index < benchStage_end) ? run->seconds[index] : total;
+
+		if (index == 0)
+			printf("%8ld %8d  ", lines, run->words);
+		else
+			printf("%8s %8s  ", "", "");
+		printf("%-15s %10.6f", (index < benchStage_end) ? stageNames[index] : "all stages", seconds);
+		/* a stage that took less than the clock can tell has no rate */
+		if (seconds > 0)
+			printf(" %12.0f %12.0f %8.0f\n", lines / seconds, run->words / seconds, seconds * 1e9 / lines);
+		else
+			printf(" %12s %12s %8s\n", "-", "-", "-");
+	}
+}
+
+/*___Error list___ */
+const char *benchErrList[] =
+{
+	"Invalid command line arguments (usage: benchmark [-sizes <n,n,...>] [-runs <n>] [-labels <n>] [-macros <n>] [-defines <n>] [-data <n>] [-externs <n>] [-indexes <n>] [-write <name>])",
+	"Could not read the sample",
+	"The sample could not be assembled",
+	"The assembler's output differs from the sample's expected output file",
+	"Could not generate or assemble the source of the following number of lines"
+};
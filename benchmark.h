@@ -0,0 +1,110 @@
+/* ___The benchmark's library___ */
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/* ___Include___ */
+#include "libassembler.h"
+#include "source_reader.h"
+
+/* ___Definitions___ */
+#define OPT_SIZES "-sizes"
+#define OPT_RUNS "-runs"
+#define OPT_LABELS "-labels"
+#define OPT_MACROS "-macros"
+#define OPT_DEFINES "-defines"
+#define OPT_DATA "-data"
+#define OPT_EXTERNS "-externs"
+#define OPT_INDEXES "-indexes"
+#define OPT_WRITE "-write"
+#define COUNT_OPTIONS 7 /* the options of the mix, and -runs */
+#define MAX_SIZES 16
+#define DEFAULT_RUNS 3
+#define SAMPLE_NAME "ps run example/ps" /* the sample, whose outputs are checked before anything is measured */
+#define BENCH_NAME "bench"				/* the name of a generated source, in its diagnostics */
+#define BENCH_NAME_LENGTH 32
+
+/* the lines of a generated source, and the words they take */
+#define MCR_BODY_LINES 3
+#define MCR_WORDS 6		  /* inc, prn and sub, two words each */
+#define LABEL_WORDS 2	  /* bne to a label */
+#define EXTERN_REF_WORDS 2 /* jsr to an extern */
+#define INDEX_WORDS 4	  /* mov from a constant index to a register */
+#define DATA_WORDS 3	  /* .data of three numbers */
+#define STRING_WORDS 5	  /* .string of four characters */
+
+/* ___Enums___ */
+/* the stages that are measured - the second pass formats its output files in memory, and does not write them */
+enum benchStage
+{
+	benchStage_pp,
+	benchStage_fp,
+	benchStage_sp,
+	benchStage_end
+};
+
+/* Enum defining error indices related to the benchmark. */
+/* prefix 'BENCH' indicates benchmark context */
+enum benchErrIndex
+{
+	BENCH_ERR_USAGE,		   /* The command line arguments are not valid */
+	BENCH_ERR_SAMPLE_READ,	   /* The sample could not be read */
+	BENCH_ERR_SAMPLE_ASSEMBLE, /* The sample had errors */
+	BENCH_ERR_SAMPLE_DIFF,	   /* The outputs of the sample are not the expected ones */
+	BENCH_ERR_SOURCE		   /* A source could not be generated or assembled */
+};
+
+/* ___Typedef___ */
+/* the mix of a generated source - the number of lines of every kind in a block */
+typedef struct sourceMix
+{
+	int labels,	 /* labelled instructions, jumping to a label */
+		macros,	 /* macros, every one defined and expanded once */
+		defines, /* .define constants */
+		data,	 /* .data and .string directives, one after the other */
+		externs, /* .extern labels, every one referenced once */
+		indexes; /* instructions with a constant index operand */
+} sourceMix;
+
+/* a source being generated, block after block */
+typedef struct sourceGen
+{
+	outputBuffer *src;
+	long lines,
+		target;	 /* the number of lines to generate */
+	int words,	 /* of the code and data images */
+		full,	 /* set once a block's words would not fit in the memory - the blocks after it only have definitions */
+		labels,	 /* the names used so far, of every kind */
+		macros,
+		defines,
+		data,
+		externs;
+} sourceGen;
+
+/* the outcome of assembling a source once, stage by stage */
+typedef struct stageRun
+{
+	double seconds[benchStage_end];
+	int words; /* of the code and data images */
+	outputBuffer ob,
+		ent,
+		ext;
+} stageRun;
+
+/* ___Constants___ */
+extern const char *benchErrList[];
+
+/* ___Prototypes___*/
+int parse_bench_options(int argc, char *argv[], sourceMix *mix, long sizes[], int *sizeCount, int *runs, char **writeName);
+int parse_sizes(char *list, long sizes[], int *sizeCount);
+int gen_line(sourceGen *gen, const char *format, ...);
+int block_words(const sourceMix *mix);
+int gen_block(sourceGen *gen, const sourceMix *mix);
+int gen_source(const sourceMix *mix, long lines, outputBuffer *src, int *full);
+double now_seconds(void);
+int run_stages(asmSession *session, char *name, const char *chars, long size, stageRun *run);
+void free_stage_run(stageRun *run);
+int same_output(const char *name, outputBuffer *out);
+int check_sample(const errStage *stage, asmSession *session);
+void print_stages(long lines, stageRun *run);
+
+#endif
@@ -0,0 +1,318 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "cache.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <unistd.h>
+
+/* ___The output cache___ */
+/* A file that was assembled with no errors has its outputs kept in a cache directory, in a single entry
+   named after a hash of the source's bytes, the assembler's version and the options.
+   A file whose entry is found is not assembled again - its outputs are written from the entry.
+   An entry is made of CACHE_MAGIC, the source's size, a byte of outputFile flags,
+   and the size and contents of every output file it holds, in the order of outputKinds. */
+
+/* the output files of a source, in the order they are written and announced */
+const outputKind outputKinds[OUTPUT_KINDS] =
+{
+	{OUTPUT_AM, ".am", ">>> A Macro-expanded file (.am) was added to the directory."},
+	{OUTPUT_OBJ, ".obj", ">>> A Binary object file (.obj) was added to the directory."},
+	{OUTPUT_OB, ".ob", ">>> An Object file (.ob) was added to the directory."},
+	{OUTPUT_EXT, ".ext", ">>> An Extern file (.ext) was added to the directory."},
+	{OUTPUT_ENT, ".ent", ">>> An Entry file (.ent) was added to the directory."}
+};
+
+/* Creates the cache directory, if it does not exist yet.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - cacheDir: The cache directory.
+
+   Returns:
+   - 1 (TRUE) if the directory exists.
+   - -1 (FUNC_ERROR) if it could not be created.
+*/
+int open_cache(const errStage *stage, const char *cacheDir)
+{
+	if (mkdir(cacheDir, 0777) != 0 && errno != EEXIST)
+	{
+		err_wo_line(stage, cacheErrList[CACHE_ERR_DIR], (char *)cacheDir);
+		return FUNC_ERROR;
+	}
+	return TRUE;
+}
+
+/* Adds bytes to a pair of 32 bit hashes - FNV-1a, and a multiplicative hash with a different prime.
+   Parameters:
+   - bytes: The bytes to add.
+   - size: The number of bytes.
+   - hash: The two hashes, updated in place.
+*/
+void hash_bytes(const char *bytes, long size, unsigned long hash[])
+{
+	unsigned long first = hash[0],
+				  second = hash[1];
+	long index;
+
+	for (index = 0; index < size; index++)
+	{
+		first = ((first ^ (unsigned char)bytes[index]) * FNV_PRIME) & HASH_MASK;
+		second = ((second + (unsigned char)bytes[index]) * MIX_PRIME) & HASH_MASK;
+		second ^= second >> 13;
+	}
+
+	hash[0] = first;
+	hash[1] = second;
+}
+
+/* Finds the cache key of a source, from the copy the pre-processor reads as well.
+   Parameters:
+   - source: The source, in memory.
+   - options: The options that change the outputs, as a number.
+   - key: Where the key is put (CACHE_KEY_LENGTH characters, null terminated).
+*/
+void source_key(const sourceFile *source, int options, char key[])
+{
+	unsigned long hash[2] = {FNV_OFFSET, MIX_OFFSET};
+
+	char prefix[sizeof(ASM_VERSION) + 16];
+
+	/* the version and the options come before the source, so a change in either changes every key */
+	sprintf(prefix, "%s %d\n", ASM_VERSION, options);
+	hash_bytes(prefix, (long)strlen(prefix), hash);
+	hash_bytes(source->chars, source->size, hash);
+
+	sprintf(key, "%08lx%08lx", hash[0], hash[1]);
+}
+
+/* Makes the name of a cache entry.
+   Parameters:
+   - cacheDir: The cache directory.
+   - key: The entry's key.
+
+   Returns:
+   - The name, which should be freed, or NULL if there was an error during memory allocation.
+*/
+char *cache_entry_name(const char *cacheDir, const char *key)
+{
+	char *name = (char *)malloc(strlen(cacheDir) + strlen(key) + 2);
+
+	if (name != NULL)
+		sprintf(name, "%s/%s", cacheDir, key);
+	return name;
+}
+
+/* Reads a size kept in an entry. */
+long get_cache_field(const char *field)
+{
+	return (long)(unsigned char)field[0] | ((long)(unsigned char)field[1] << 8) |
+		   ((long)(unsigned char)field[2] << 16) | ((long)(unsigned char)field[3] << 24);
+}
+
+/* Adds a size to an entry, which has room for it. */
+void put_cache_field(outputBuffer *entry, long size)
+{
+	int index;
+
+	for (index = 0; index < CACHE_FIELD_SIZE; index++)
+		entry->chars[entry->size++] = (char)((size >> (8 * index)) & 0xFF);
+}
+
+/* Writes the outputs of a source from its cache entry.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - cacheDir: The cache directory.
+   - key: The source's key.
+   - sourceSize: The source's size, which the entry should match.
+   - baseName: The file's name, without the .as extension.
+   - outputs: Where the output files that were written are put, as outputFile flags.
+
+   Returns:
+   - 1 (TRUE) if the outputs were restored.
+   - 0 (FALSE) if there is no entry for the source, or it is not valid.
+   - -1 (FUNC_ERROR) if an output file could not be written.
+
+   Notes:
+   - The entry is checked as a whole before any file is written.
+   - The output files the entry does not have are removed, so a restored source leaves the same files as an assembled one.
+*/
+int restore_cached(const errStage *stage, const char *cacheDir, const char *key, long sourceSize, char *baseName, int *outputs)
+{
+	sourceFile entry = {NULL, 0, 0, FALSE};
+
+	outputBuffer out;
+
+	long sizes[OUTPUT_KINDS],
+		pos,
+		header = CACHE_MAGIC_LENGTH + CACHE_FIELD_SIZE + 1;
+
+	int index,
+		flags;
+
+	char *name;
+
+	if ((name = cache_entry_name(cacheDir, key)) == NULL)
+		return FALSE;
+	if (open_source(name, &entry) == FUNC_ERROR)
+	{
+		free(name);
+		return FALSE;
+	}
+	free(name);
+	count_io(stage, TRUE, entry.size, 0);
+
+	/* ___Checking the entry___ */
+	if (entry.size < header || memcmp(entry.chars, CACHE_MAGIC, CACHE_MAGIC_LENGTH) != 0 ||
+		get_cache_field(entry.chars + CACHE_MAGIC_LENGTH) != sourceSize)
+	{
+		close_source(&entry);
+		return FALSE;
+	}
+
+	flags = (unsigned char)entry.chars[header - 1];
+	for (index = 0, pos = header; index < OUTPUT_KINDS; index++)
+	{
+		sizes[index] = 0;
+		if (!(flags & outputKinds[index].flag))
+			continue;
+
+		if (entry.size - pos < CACHE_FIELD_SIZE ||
+			(sizes[index] = get_cache_field(entry.chars + pos)) > entry.size - pos - CACHE_FIELD_SIZE)
+		{
+			close_source(&entry);
+			return FALSE;
+		}
+		pos += CACHE_FIELD_SIZE + sizes[index];
+	}
+	if (pos != entry.size)
+	{
+		close_source(&entry);
+		return FALSE;
+	}
+
+	/* ___Writing the output files___ */
+	for (index = 0, pos = header; index < OUTPUT_KINDS; index++)
+	{
+		if ((name = add_ext(baseName, outputKinds[index].ext)) == NULL)
+		{
+			close_source(&entry);
+			return FUNC_ERROR;
+		}
+
+		/* an output the entry does not have is removed, as the second pass removes it - but not the .am file, which is only written with -am */
+		if (!(flags & outputKinds[index].flag))
+		{
+			if (outputKinds[index].flag != OUTPUT_AM)
+				remove(name);
+			free(name);
+			continue;
+		}
+
+		out.chars = entry.chars + pos + CACHE_FIELD_SIZE;
+		out.size = out.capacity = (int)sizes[index];
+		pos += CACHE_FIELD_SIZE + sizes[index];
+
+		if (write_output(stage, name, &out) == FUNC_ERROR)
+		{
+			free(name);
+			close_source(&entry);
+			return FUNC_ERROR;
+		}
+		free(name);
+	}
+	close_source(&entry);
+
+	*outputs = flags;
+	return TRUE;
+}
+
+/* Keeps the outputs of a source that was assembled with no errors in its cache entry.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - cacheDir: The cache directory.
+   - key: The source's key.
+   - sourceSize: The source's size.
+   - baseName: The file's name, without the .as extension.
+   - outputs: The output files that were written, as outputFile flags.
+   - kept: The contents of the output files, as they were staged and written, in the order of outputKinds.
+
+   Returns:
+   - 1 (TRUE) if the entry was stored.
+   - -1 (FUNC_ERROR) if the entry could not be written.
+
+   Notes:
+   - The entry is written under a name of its own, and renamed into place,
+	 so workers that assemble the same source at once never see a partial entry.
+*/
+int store_cached(const errStage *stage, const char *cacheDir, const char *key, long sourceSize, char *baseName, int outputs, outputBuffer kept[])
+{
+	outputBuffer entry = {NULL, 0, 0};
+
+	int index,
+		res = TRUE;
+
+	char *name = NULL,
+		 *tempName = NULL;
+
+	if (reserve_output(&entry, CACHE_MAGIC_LENGTH + CACHE_FIELD_SIZE + 1) == FUNC_ERROR)
+		res = FUNC_ERROR;
+	else
+	{
+		memcpy(entry.chars, CACHE_MAGIC, CACHE_MAGIC_LENGTH);
+		entry.size = CACHE_MAGIC_LENGTH;
+		put_cache_field(&entry, sourceSize);
+		entry.chars[entry.size++] = (char)outputs;
+	}
+
+	/* ___Adding the output files, from the buffers they were written from___ */
+	for (index = 0; index < OUTPUT_KINDS && res == TRUE; index++)
+	{
+		if (!(outputs & outputKinds[index].flag))
+			continue;
+
+		if (reserve_output(&entry, CACHE_FIELD_SIZE + kept[index].size) == FUNC_ERROR)
+			res = FUNC_ERROR;
+		else
+		{
+			put_cache_field(&entry, kept[index].size);
+			if (kept[index].size > 0)
+				memcpy(entry.chars + entry.size, kept[index].chars, kept[index].size);
+			entry.size += kept[index].size;
+		}
+	}
+
+	/* ___Writing the entry___ */
+	if (res == TRUE)
+	{
+		if ((name = cache_entry_name(cacheDir, key)) == NULL ||
+			(tempName = (char *)malloc(strlen(name) + 24)) == NULL)
+			res = FUNC_ERROR;
+		else
+		{
+			sprintf(tempName, "%s.%ld", name, (long)getpid());
+			if (write_output(stage, tempName, &entry) == FUNC_ERROR)
+				res = FUNC_ERROR;
+			else if (rename(tempName, name) != 0)
+			{
+				remove(tempName);
+				res = FUNC_ERROR;
+			}
+		}
+	}
+
+	if (res == FUNC_ERROR)
+		err_wo_line(stage, cacheErrList[CACHE_ERR_STORE], baseName);
+
+	free(name);
+	free(tempName);
+	free_output_buffer(&entry);
+	return res;
+}
+
+/*___Error list___ */
+const char *cacheErrList[] =
+{
+	"Could not create the cache directory",
+	"Could not store the outputs of the file in the cache"
+};
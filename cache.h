@@ -0,0 +1,52 @@
+/* ___The output cache's library___ */
+#ifndef CACHE_H
+#define CACHE_H
+
+/* ___Include___ */
+#include "libassembler.h"
+#include "source_reader.h"
+
+/* ___Definitions___ */
+/* changed whenever the assembler's output changes, so entries of an older assembler are not restored */
+#define ASM_VERSION "assembler 1.21"
+#define CACHE_MAGIC "ASC1"
+#define CACHE_MAGIC_LENGTH 4
+#define CACHE_KEY_LENGTH 16 /* two 32 bit hashes, in hexadecimal */
+#define CACHE_FIELD_SIZE 4	/* sizes are kept in 4 bytes, least significant first */
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME 16777619UL
+#define MIX_OFFSET 2654435769UL
+#define MIX_PRIME 2246822519UL
+#define HASH_MASK 0xFFFFFFFFUL
+
+/* ___Enums___ */
+/* Enum defining error indices related to the output cache. */
+/* prefix 'CACHE' indicates output cache context */
+enum cacheErrIndex
+{
+	CACHE_ERR_DIR,	/* Could not create the cache directory */
+	CACHE_ERR_STORE /* Could not store a file's outputs in the cache */
+};
+
+/* ___Typedef___ */
+/* a kind of output file - what a cache entry can hold, and how it is announced when it is written */
+typedef struct outputKind
+{
+	int flag; /* its outputFile flag */
+	char *ext;
+	const char *message;
+} outputKind;
+
+/* ___Constants___ */
+extern const char *cacheErrList[];
+extern const outputKind outputKinds[];
+
+/* ___Prototypes___*/
+int open_cache(const errStage *stage, const char *cacheDir);
+void hash_bytes(const char *bytes, long size, unsigned long hash[]);
+void source_key(const sourceFile *source, int options, char key[]);
+char *cache_entry_name(const char *cacheDir, const char *key);
+int restore_cached(const errStage *stage, const char *cacheDir, const char *key, long sourceSize, char *baseName, int *outputs);
+int store_cached(const errStage *stage, const char *cacheDir, const char *key, long sourceSize, char *baseName, int outputs, outputBuffer kept[]);
+
+#endif
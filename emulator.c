@@ -0,0 +1,682 @@
+#include "emulator.h"
+
+/* the executors of the instructions, indexed by opcode */
+const executor executors[Element_instructionEnd] =
+{
+	exec_mov, exec_cmp, exec_add, exec_sub,
+	exec_not, exec_clr, exec_lea, exec_inc,
+	exec_dec, exec_jmp, exec_bne, exec_red,
+	exec_prn, exec_jsr, exec_rts, exec_hlt
+};
+
+/* ___The emulator___ */
+/* Runs an assembled (or linked) file, starting at IMAGE_OFFSET, until it halts.
+   - Every instruction is decoded once, on its first execution, and kept in an instruction cache
+     (an instruction is decoded again if one of its words is written to).
+   - The decoded instructions are executed through a table of executors, indexed by opcode.
+   - prn prints a character to the standard output, red reads one from the standard input.
+
+   Usage: emulator [-p] [-n <max instructions>] <file>
+   The file is given without an extension, and its .ob file is read.
+   With -p, the number of instructions executed under every label of its .ent file is reported once it halts.
+
+   Returns:
+   - 0 (SUCCESS): The program halted.
+   - -1 (QUIT_UPON_ERROR): The file could not be loaded, or a runtime error occurred.
+*/
+int main(int argc, char *argv[])
+{
+	/* ___Declarations___ */
+	objectImage image = {NULL, NULL, 0, 0, NULL};
+
+	machine *m = NULL;
+
+	profileLabel *labels = NULL;
+
+	int fileIndex,
+		profile = FALSE,
+		labelCount = 0,
+		res;
+
+	long maxSteps = DEFAULT_MAX_STEPS;
+
+	/* errors are printed to stderr */
+	const errStage emuStage = {"emulator", NULL},
+				   *stage = &emuStage;
+
+	if ((fileIndex = parse_emu_options(argc, argv, &profile, &maxSteps)) == FUNC_ERROR)
+	{
+		err_wo_line(stage, emuErrList[EMU_ERR_USAGE], NULL);
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Loading the file___ */
+	image.baseName = argv[fileIndex];
+	if (read_ob(stage, &image) != TRUE)
+	{
+		EMU_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	if ((m = (machine *)calloc(1, sizeof(machine))) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		EMU_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+	m->stage = stage;
+	m->maxSteps = maxSteps;
+
+	if (load_image(m, &image) != TRUE)
+	{
+		EMU_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	/* the labels are only needed for the profile */
+	if (profile && (labels = read_labels(stage, image.baseName, &labelCount)) == NULL && labelCount == FUNC_ERROR)
+	{
+		EMU_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Running___ */
+	res = run(m);
+	fflush(stdout);
+
+	if (profile)
+		print_profile(m, labels, labelCount);
+
+	EMU_CLOSE
+	return (res == TRUE) ? SUCCESS : QUIT_UPON_ERROR;
+}
+
+/* ___Helper functions___ */
+
+/* Reads the command line options, which are given before the file.
+   Parameters:
+   - argc, argv: The command line arguments.
+   - profile: Set if a profile was asked for.
+   - maxSteps: Set to the maximal number of instructions, if it was given.
+
+   Returns:
+   - The index of the file in argv.
+   - -1 (FUNC_ERROR) if the arguments are not valid.
+*/
+int parse_emu_options(int argc, char *argv[], int *profile, long *maxSteps)
+{
+	int index;
+	char *end;
+
+	for (index = 1; index < argc && argv[index][0] == '-'; index++)
+	{
+		if (strcmp(argv[index], OPT_PROFILE) == 0)
+			*profile = TRUE;
+		else if (strcmp(argv[index], OPT_MAX_STEPS) == 0 && index + 1 < argc)
+		{
+			*maxSteps = strtol(argv[++index], &end, 10);
+			if (*end != '\0' || *maxSteps <= 0)
+				return FUNC_ERROR;
+		}
+		else
+			return FUNC_ERROR;
+	}
+	return (index == argc - 1) ? index : FUNC_ERROR;
+}
+
+/* Places the code and data images in the memory, and sets the program counter to the first instruction.
+   Parameters:
+   - m: The machine.
+   - image: The file's image.
+
+   Returns:
+   - 1 (TRUE) if the image was loaded.
+   - -1 (FUNC_ERROR) if it does not fit in the memory.
+*/
+int load_image(machine *m, objectImage *image)
+{
+	int index;
+
+	if (IMAGE_OFFSET + image->IC + image->DC > RAM_SIZE)
+	{
+		err_wo_line(m->stage, emuErrList[EMU_ERR_IMAGE_SIZE], image->obName);
+		return FUNC_ERROR;
+	}
+
+	for (index = 0; index < image->IC + image->DC; index++)
+		m->memory[IMAGE_OFFSET + index] = image->words[index] & WORD_MASK;
+
+	m->codeEnd = IMAGE_OFFSET + image->IC;
+	m->PC = IMAGE_OFFSET;
+	return TRUE;
+}
+
+/* Prints a runtime error.
+   Parameters:
+   - m: The machine.
+   - text: The index of the error in the error list.
+   - address: The address the error refers to.
+
+   Returns:
+   - -1 (FUNC_ERROR), for the callers to pass on.
+*/
+int emu_error(machine *m, int text, int address)
+{
+	char spec[MAX_LINE_LENGTH + 1];
+
+	sprintf(spec, "%d", address);
+	err_wo_line(m->stage, emuErrList[text], spec);
+	return FUNC_ERROR;
+}
+
+/* Decodes an operand from the words following an instruction's first word, the way build_operand_word encodes it.
+   Parameters:
+   - m: The machine.
+   - address: The address of the instruction's first word.
+   - words: The number of words of the instruction decoded so far, advanced past the operand's words.
+   - method: The operand's addressing method.
+   - isSrc: Whether this is the source operand.
+   - op: The operand to fill.
+
+   Returns:
+   - 1 (TRUE) if the operand was decoded.
+   - -1 (FUNC_ERROR) if its words are outside of the code section, or are an extern reference.
+*/
+int decode_operand(machine *m, int address, int *words, int method, int isSrc, operand *op)
+{
+	int word;
+
+	op->method = method;
+	op->index = 0;
+
+	if (address + *words >= m->codeEnd)
+		return emu_error(m, EMU_ERR_INVALID_INST, address);
+	word = m->memory[address + (*words)++];
+
+	switch (method)
+	{
+	case addMethod_immediate:
+		op->value = SIGN_EXTEND(word >> IMM_OP_MOVE, OC_INT_BIT_LENGTH);
+		break;
+
+	case addMethod_constInd:
+	case addMethod_direct:
+		if ((word & ARE_MASK) == EXTERNAL)
+			return emu_error(m, EMU_ERR_UNRESOLVED_EXTERN, address + *words - 1);
+		op->value = word >> LABEL_ADD_MOVE;
+
+		/* the index follows the label's word */
+		if (method == addMethod_constInd)
+		{
+			if (address + *words >= m->codeEnd)
+				return emu_error(m, EMU_ERR_INVALID_INST, address);
+			word = m->memory[address + (*words)++];
+			op->index = SIGN_EXTEND(word >> IMM_OP_MOVE, OC_INT_BIT_LENGTH);
+		}
+		break;
+
+	case addMethod_directReg:
+		op->value = (word >> (isSrc ? SRC_REG_MOVE : DEST_REG_MOVE)) & REG_MASK;
+		break;
+	}
+	return TRUE;
+}
+
+/* Decodes the instruction at an address into the instruction cache, the way first_pass_binary encodes it.
+   Parameters:
+   - m: The machine.
+   - address: The address of the instruction's first word.
+
+   Returns:
+   - 1 (TRUE) if the instruction was decoded.
+   - -1 (FUNC_ERROR) if it is not a valid instruction.
+*/
+int decode_instruction(machine *m, int address)
+{
+	decodedInst *inst = &m->cache[address];
+
+	int word = m->memory[address],
+		words = 1,
+		srcMethod,
+		destMethod;
+
+	inst->opcode = (word >> OPCODE_MOVE) & OPCODE_MASK;
+	srcMethod = (word >> SRC_OP_MOVE) & ADD_METHOD_MASK;
+	destMethod = (word >> DEST_OP_MOVE) & ADD_METHOD_MASK;
+
+	/* the first word is absolute, and its addressing methods must be allowed for its opcode */
+	if ((word & ARE_MASK) != ABSOLUTE || (word >> FIRST_WORD_BITS) != 0 ||
+		(srcAddMask[inst->opcode] == 0 && srcMethod != 0) || (destAddMask[inst->opcode] == 0 && destMethod != 0) ||
+		(srcAddMask[inst->opcode] != 0 && !(srcAddMask[inst->opcode] & (1 << srcMethod))) ||
+		(destAddMask[inst->opcode] != 0 && !(destAddMask[inst->opcode] & (1 << destMethod))))
+		return emu_error(m, EMU_ERR_INVALID_INST, address);
+
+	/* both operands are registers, and share a word */
+	if (srcAddMask[inst->opcode] != 0 && srcMethod == addMethod_directReg && destMethod == addMethod_directReg)
+	{
+		if (decode_operand(m, address, &words, srcMethod, TRUE, &inst->src) != TRUE)
+			return FUNC_ERROR;
+		words--;
+		if (decode_operand(m, address, &words, destMethod, FALSE, &inst->dest) != TRUE)
+			return FUNC_ERROR;
+	}
+	else
+	{
+		if (srcAddMask[inst->opcode] != 0 && decode_operand(m, address, &words, srcMethod, TRUE, &inst->src) != TRUE)
+			return FUNC_ERROR;
+		if (destAddMask[inst->opcode] != 0 && decode_operand(m, address, &words, destMethod, FALSE, &inst->dest) != TRUE)
+			return FUNC_ERROR;
+	}
+
+	inst->length = words;
+	inst->valid = TRUE;
+	return TRUE;
+}
+
+/* Runs the program until it halts.
+   Parameters:
+   - m: The machine, with the image loaded.
+
+   Returns:
+   - 1 (TRUE) if the program halted.
+   - -1 (FUNC_ERROR) if a runtime error occurred.
+*/
+int run(machine *m)
+{
+	decodedInst *inst;
+
+	int address;
+
+	while (!m->halted)
+	{
+		address = m->PC;
+		if (address < IMAGE_OFFSET || address >= m->codeEnd)
+			return emu_error(m, EMU_ERR_PC_RANGE, address);
+
+		inst = &m->cache[address];
+		if (!inst->valid && decode_instruction(m, address) != TRUE)
+			return FUNC_ERROR;
+
+		if (m->steps == m->maxSteps)
+			return emu_error(m, EMU_ERR_STEP_LIMIT, address);
+		m->steps++;
+		m->counts[address]++;
+
+		/* jumps replace the following instruction */
+		m->PC = address + inst->length;
+		if (executors[inst->opcode](m, inst) != TRUE)
+			return FUNC_ERROR;
+	}
+	return TRUE;
+}
+
+/* Finds the address an operand refers to.
+   Parameters:
+   - m: The machine.
+   - op: The operand (not immediate).
+   - address: Set to the address.
+
+   Returns:
+   - 1 (TRUE) if the address is inside of the memory.
+   - -1 (FUNC_ERROR) otherwise.
+*/
+int operand_address(machine *m, operand *op, int *address)
+{
+	if (op->method == addMethod_directReg)
+		*address = m->regs[op->value];
+	else
+		*address = op->value + op->index;
+
+	if (*address < 0 || *address >= RAM_SIZE)
+		return emu_error(m, EMU_ERR_ADDRESS_RANGE, m->PC);
+	return TRUE;
+}
+
+/* Reads the value of an operand.
+   Parameters:
+   - m: The machine.
+   - op: The operand.
+   - value: Set to the operand's value.
+
+   Returns:
+   - 1 (TRUE) if the value was read.
+   - -1 (FUNC_ERROR) if the operand's address is outside of the memory.
+*/
+int read_operand(machine *m, operand *op, int *value)
+{
+	int address;
+
+	switch (op->method)
+	{
+	case addMethod_immediate:
+		*value = op->value;
+		return TRUE;
+
+	case addMethod_directReg:
+		*value = m->regs[op->value];
+		return TRUE;
+	}
+
+	if (operand_address(m, op, &address) != TRUE)
+		return FUNC_ERROR;
+
+	*value = WORD_VALUE(m->memory[address]);
+	return TRUE;
+}
+
+/* Writes a value to an operand (not immediate).
+   Parameters:
+   - m: The machine.
+   - op: The operand.
+   - value: The value, cut to the size of a word.
+
+   Returns:
+   - 1 (TRUE) if the value was written.
+   - -1 (FUNC_ERROR) if the operand's address is outside of the memory.
+
+   Notes:
+   - Writing to the code section drops the cached instructions that the word may be part of.
+*/
+int write_operand(machine *m, operand *op, int value)
+{
+	int address,
+		index;
+
+	if (op->method == addMethod_directReg)
+	{
+		m->regs[op->value] = WORD_VALUE(value);
+		return TRUE;
+	}
+
+	if (operand_address(m, op, &address) != TRUE)
+		return FUNC_ERROR;
+
+	m->memory[address] = value & WORD_MASK;
+
+	if (address < m->codeEnd)
+	{
+		for (index = address; index >= 0 && index > address - MAX_INST_WORDS; index--)
+			m->cache[index].valid = FALSE;
+	}
+	return TRUE;
+}
+
+/* ___The executors___ */
+/* Every executor gets the machine and the decoded instruction.
+   Returns:
+   - 1 (TRUE) if the instruction was executed.
+   - -1 (FUNC_ERROR) if a runtime error occurred.
+*/
+
+int exec_mov(machine *m, decodedInst *inst)
+{
+	int value;
+
+	if (read_operand(m, &inst->src, &value) != TRUE)
+		return FUNC_ERROR;
+	return write_operand(m, &inst->dest, value);
+}
+
+int exec_cmp(machine *m, decodedInst *inst)
+{
+	int first,
+		second;
+
+	if (read_operand(m, &inst->src, &first) != TRUE || read_operand(m, &inst->dest, &second) != TRUE)
+		return FUNC_ERROR;
+
+	m->zeroFlag = (WORD_VALUE(first - second) == 0);
+	return TRUE;
+}
+
+int exec_add(machine *m, decodedInst *inst)
+{
+	int first,
+		second;
+
+	if (read_operand(m, &inst->src, &first) != TRUE || read_operand(m, &inst->dest, &second) != TRUE)
+		return FUNC_ERROR;
+	return write_operand(m, &inst->dest, second + first);
+}
+
+int exec_sub(machine *m, decodedInst *inst)
+{
+	int first,
+		second;
+
+	if (read_operand(m, &inst->src, &first) != TRUE || read_operand(m, &inst->dest, &second) != TRUE)
+		return FUNC_ERROR;
+	return write_operand(m, &inst->dest, second - first);
+}
+
+int exec_not(machine *m, decodedInst *inst)
+{
+	int value;
+
+	if (read_operand(m, &inst->dest, &value) != TRUE)
+		return FUNC_ERROR;
+	return write_operand(m, &inst->dest, ~value);
+}
+
+int exec_clr(machine *m, decodedInst *inst)
+{
+	return write_operand(m, &inst->dest, 0);
+}
+
+int exec_lea(machine *m, decodedInst *inst)
+{
+	int address;
+
+	if (operand_address(m, &inst->src, &address) != TRUE)
+		return FUNC_ERROR;
+	return write_operand(m, &inst->dest, address);
+}
+
+int exec_inc(machine *m, decodedInst *inst)
+{
+	int value;
+
+	if (read_operand(m, &inst->dest, &value) != TRUE)
+		return FUNC_ERROR;
+	return write_operand(m, &inst->dest, value + 1);
+}
+
+int exec_dec(machine *m, decodedInst *inst)
+{
+	int value;
+
+	if (read_operand(m, &inst->dest, &value) != TRUE)
+		return FUNC_ERROR;
+	return write_operand(m, &inst->dest, value - 1);
+}
+
+int exec_jmp(machine *m, decodedInst *inst)
+{
+	return operand_address(m, &inst->dest, &m->PC);
+}
+
+int exec_bne(machine *m, decodedInst *inst)
+{
+	if (m->zeroFlag)
+		return TRUE;
+	return operand_address(m, &inst->dest, &m->PC);
+}
+
+int exec_red(machine *m, decodedInst *inst)
+{
+	int c = getchar();
+
+	return write_operand(m, &inst->dest, (c == EOF) ? -1 : c);
+}
+
+int exec_prn(machine *m, decodedInst *inst)
+{
+	int value;
+
+	if (read_operand(m, &inst->dest, &value) != TRUE)
+		return FUNC_ERROR;
+
+	putchar((unsigned char)value);
+	return TRUE;
+}
+
+int exec_jsr(machine *m, decodedInst *inst)
+{
+	int address;
+
+	if (m->stackSize == CALL_STACK_SIZE)
+		return emu_error(m, EMU_ERR_STACK_OVERFLOW, m->PC - inst->length);
+
+	if (operand_address(m, &inst->dest, &address) != TRUE)
+		return FUNC_ERROR;
+
+	m->stack[m->stackSize++] = m->PC;
+	m->PC = address;
+	return TRUE;
+}
+
+int exec_rts(machine *m, decodedInst *inst)
+{
+	if (m->stackSize == 0)
+		return emu_error(m, EMU_ERR_STACK_UNDERFLOW, m->PC - inst->length);
+
+	m->PC = m->stack[--m->stackSize];
+	return TRUE;
+}
+
+int exec_hlt(machine *m, decodedInst *inst)
+{
+	m->halted = TRUE;
+	return TRUE;
+}
+
+/* ___The profile___ */
+
+/* Reads the labels of a file's .ent file.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - baseName: The file's base name.
+   - count: Set to the number of labels, or to -1 (FUNC_ERROR) if there was an error.
+
+   Returns:
+   - The labels, in the order of the file (NULL if there are none).
+
+   Notes:
+   - A file without a .ent file, or with invalid lines, has its profile reported without labels.
+*/
+profileLabel *read_labels(const errStage *stage, char *baseName, int *count)
+{
+	sourceFile ent;
+	lineSlice line;
+	profileLabel *labels = NULL,
+				 *temp;
+
+	char *entName;
+
+	int capacity = 0;
+
+	*count = 0;
+
+	if ((entName = add_ext(baseName, ".ent")) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		*count = FUNC_ERROR;
+		return NULL;
+	}
+	if (open_source(entName, &ent) == FUNC_ERROR)
+	{
+		free(entName);
+		return NULL;
+	}
+
+	while (next_line(&ent, &line))
+	{
+		if (*count == capacity)
+		{
+			capacity = (capacity == 0) ? PROFILE_INIT_SIZE : capacity * 2;
+			if ((temp = (profileLabel *)realloc(labels, capacity * sizeof(profileLabel))) == NULL)
+			{
+				err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+				free(labels);
+				labels = NULL;
+				*count = FUNC_ERROR;
+				break;
+			}
+			labels = temp;
+		}
+
+		if (parse_symbol_line(&line, labels[*count].name, &labels[*count].address))
+			(*count)++;
+	}
+
+	close_source(&ent);
+	free(entName);
+	return labels;
+}
+
+/* Orders profile labels by their addresses, for qsort.
+   Parameters:
+   - first, second: Pointers to the labels.
+
+   Returns:
+   - A negative, zero, or positive number, as the first label's address is lower, equal, or higher.
+*/
+int compare_labels(const void *first, const void *second)
+{
+	return ((const profileLabel *)first)->address - ((const profileLabel *)second)->address;
+}
+
+/* Prints the number of instructions executed under every label of the code section, to the standard error.
+   Parameters:
+   - m: The machine, after running.
+   - labels: The labels (their order is changed).
+   - labelCount: The number of labels.
+
+   Notes:
+   - A label counts the instructions from its address up to the next label's address.
+*/
+void print_profile(machine *m, profileLabel labels[], int labelCount)
+{
+	int index,
+		address,
+		end;
+
+	long count;
+
+	if (labelCount > 0)
+		qsort(labels, labelCount, sizeof(profileLabel), compare_labels);
+
+	fprintf(stderr, "\n>>> Profile: %ld instructions were executed.\n", m->steps);
+	fprintf(stderr, "%-32s %12s %8s\n", "Label", "Instructions", "Share");
+
+	/* the instructions before the first label */
+	end = (labelCount > 0 && labels[0].address < m->codeEnd) ? labels[0].address : m->codeEnd;
+	for (count = 0, address = IMAGE_OFFSET; address < end; address++)
+		count += m->counts[address];
+	if (count > 0 || labelCount == 0)
+		fprintf(stderr, "%-32s %12ld %7.2f%%\n", "(no label)", count, (m->steps > 0) ? 100.0 * count / m->steps : 0.0);
+
+	for (index = 0; index < labelCount && labels[index].address < m->codeEnd; index++)
+	{
+		end = (index + 1 < labelCount && labels[index + 1].address < m->codeEnd) ? labels[index + 1].address : m->codeEnd;
+
+		for (count = 0, address = labels[index].address; address < end; address++)
+			count += m->counts[address];
+
+		fprintf(stderr, "%-32s %12ld %7.2f%%\n", labels[index].name, count, (m->steps > 0) ? 100.0 * count / m->steps : 0.0);
+	}
+}
+
+/*___Error list___ */
+const char *emuErrList[] =
+{
+	"Invalid command line arguments (usage: emulator [-p] [-n <max instructions>] <file>)",
+	"The image does not fit in the memory",
+	"The word at the following address is not a valid instruction",
+	"The program has an unresolved extern reference at the following address, it should be linked first",
+	"The program counter left the code section, at the following address",
+	"The instruction at the following address accesses an address outside of the memory",
+	"The call stack overflowed, at the following address",
+	"An rts instruction without a matching jsr, at the following address",
+	"The program did not halt within the allowed number of instructions, at the following address"
+};
@@ -0,0 +1,132 @@
+/* ___The emulator's library___ */
+#ifndef EMULATOR_H
+#define EMULATOR_H
+
+/* ___Include___ */
+#include "object_file.h"
+#include "op_tables.h"
+
+/* ___Definitions___ */
+#define OPT_PROFILE "-p"
+#define OPT_MAX_STEPS "-n"
+#define DEFAULT_MAX_STEPS 100000000L
+#define REGS_NUM (LAST_REG_NUM + 1)
+#define CALL_STACK_SIZE 1024
+#define MAX_INST_WORDS 5 /* a first word, and 2 words for each of the operands (constant index addressing) */
+#define FIRST_WORD_BITS 10 /* the bits above the opcode are not in use */
+#define PROFILE_INIT_SIZE 16
+
+/* ___Macros___ */
+/* the signed value of the given number of low bits */
+#define SIGN_EXTEND(value, bits) ((((value) & ((1 << (bits)) - 1)) ^ (1 << ((bits) - 1))) - (1 << ((bits) - 1)))
+
+/* the value of a memory word, or of a register */
+#define WORD_VALUE(word) SIGN_EXTEND((word), DIR_INT_BIT_LENGTH)
+
+#define EMU_CLOSE                      \
+	do                                 \
+	{                                  \
+		free_object_image(&image);     \
+		if (m != NULL)                 \
+			free(m);                   \
+		if (labels != NULL)            \
+			free(labels);              \
+	} while (0);
+
+/* ___Enums___ */
+/* Enum defining error indices related to the emulator. */
+/* prefix 'EMU' indicates emulator context */
+enum emuErrIndex
+{
+	EMU_ERR_USAGE,				/* The command line arguments are not valid */
+	EMU_ERR_IMAGE_SIZE,			/* The image does not fit in the memory */
+	EMU_ERR_INVALID_INST,		/* The word at the program counter is not a valid first word */
+	EMU_ERR_UNRESOLVED_EXTERN,	/* An operand is an extern reference that was not linked */
+	EMU_ERR_PC_RANGE,			/* The program counter left the code section */
+	EMU_ERR_ADDRESS_RANGE,		/* An operand's address is outside of the memory */
+	EMU_ERR_STACK_OVERFLOW,		/* Too many nested jsr instructions */
+	EMU_ERR_STACK_UNDERFLOW,	/* An rts instruction without a matching jsr */
+	EMU_ERR_STEP_LIMIT			/* The program did not halt within the allowed number of instructions */
+};
+
+/* ___Typedef___ */
+/* a decoded operand */
+typedef struct operand
+{
+	unsigned char method; /* the addressing method */
+	int value,			  /* the immediate value, the address, or the register's number */
+		index;			  /* the index of constant index addressing */
+} operand;
+
+/* an instruction, decoded once and kept in the instruction cache */
+typedef struct decodedInst
+{
+	unsigned char opcode,
+		length, /* in words */
+		valid;	/* cleared when one of its words is written to */
+	operand src,
+		dest;
+} decodedInst;
+
+/* the state of the machine */
+typedef struct machine
+{
+	int memory[RAM_SIZE]; /* 14-bit words */
+	int regs[REGS_NUM];	  /* sign extended values */
+	int PC,
+		zeroFlag, /* set by cmp */
+		codeEnd,  /* the address after the last instruction */
+		halted;
+	int stack[CALL_STACK_SIZE]; /* return addresses of jsr */
+	int stackSize;
+	long steps,
+		maxSteps;
+	decodedInst cache[RAM_SIZE]; /* keyed by the address of the first word */
+	long counts[RAM_SIZE];		 /* the number of times the instruction at every address was executed */
+	const errStage *stage;
+} machine;
+
+/* executes a decoded instruction, whose following instruction is already set as the program counter */
+typedef int (*executor)(machine *m, decodedInst *inst);
+
+/* a label of the profile report */
+typedef struct profileLabel
+{
+	char name[MAX_LINE_LENGTH + 1];
+	int address;
+} profileLabel;
+
+/* ___Constants___ */
+extern const char *emuErrList[];
+
+/* ___Prototypes___*/
+int parse_emu_options(int argc, char *argv[], int *profile, long *maxSteps);
+int load_image(machine *m, objectImage *image);
+int emu_error(machine *m, int text, int address);
+int decode_operand(machine *m, int address, int *words, int method, int isSrc, operand *op);
+int decode_instruction(machine *m, int address);
+int run(machine *m);
+int read_operand(machine *m, operand *op, int *value);
+int write_operand(machine *m, operand *op, int value);
+int operand_address(machine *m, operand *op, int *address);
+int exec_mov(machine *m, decodedInst *inst);
+int exec_cmp(machine *m, decodedInst *inst);
+int exec_add(machine *m, decodedInst *inst);
+int exec_sub(machine *m, decodedInst *inst);
+int exec_not(machine *m, decodedInst *inst);
+int exec_clr(machine *m, decodedInst *inst);
+int exec_lea(machine *m, decodedInst *inst);
+int exec_inc(machine *m, decodedInst *inst);
+int exec_dec(machine *m, decodedInst *inst);
+int exec_jmp(machine *m, decodedInst *inst);
+int exec_bne(machine *m, decodedInst *inst);
+int exec_red(machine *m, decodedInst *inst);
+int exec_prn(machine *m, decodedInst *inst);
+int exec_jsr(machine *m, decodedInst *inst);
+int exec_rts(machine *m, decodedInst *inst);
+int exec_hlt(machine *m, decodedInst *inst);
+profileLabel *read_labels(const errStage *stage, char *baseName, int *count);
+int compare_labels(const void *first, const void *second);
+void print_profile(machine *m, profileLabel labels[], int labelCount);
+
+#endif
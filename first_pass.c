@@ -6,25 +6,13 @@
    - -1 (QUIT_UPON_ERROR): An error occurred (related to malloc, files, syntax errors in the source file, etc).
    - -2 (DETECT_MORE_ERRORS): An error in the source file's syntax was detected.
 */
-int first_pass(char *baseName, char *resNames, short int codeImage[], short int **dataImage,
-			   Opcodes ocList[], Directives dirList[], symbolNode **symbolHead, needLabelNode **needLHead)
+int first_pass(diagList *diags, char *baseName, lineBuffer *amLines, resNamesIndex *resNames, short int codeImage[], dataBuffer *data,
+			   Opcodes ocList[], Directives dirList[], symbolTable *symbols, fixupTable *fixups)
 {
 	/* ___Declarations___ */
 
-	/* symbols will be stored in a linked list */
-	symbolNode *head = *symbolHead;
-
-	/* a linked list that stores the codeImage cells that need labels for the second pass */
-	needLabelNode *nlHead = *needLHead;
-
-	/* input file pointer */
-	FILE *ip = NULL;
-
 	/* additional */
-	short int *myDataImage = *dataImage,
-			  *temp = NULL;
-
-	int IC = 0, DC = 0,
+	int IC = 0,
 		lineIndex = 0,
 		foundErrorFlag = FALSE,
 		foundLabelFlag = FALSE,
@@ -33,43 +21,40 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 		currentSymbolVal = 0,
 		funcRes = 0;
 
-	const char *stage = "first pass";
+	/* the current line, and its tokens */
+	lineSlice line;
+	lineRecord tokens;
+
+	errStage fpStage;
+	const errStage *stage = &fpStage;
 	char *ipName = NULL,
-		 *tempWord = NULL,
-		 *currentLabelName = NULL,
-		 sourceLine[MAX_LINE_LENGTH + 1] = "",
-		 lineCopy[MAX_LINE_LENGTH + 1] = "";
+		 *currentLabelName = NULL;
+
+	/* the errors are kept in diags, or printed if it is NULL */
+	fpStage.name = "first pass";
+	fpStage.diags = diags;
+	fpStage.io = NULL;
 
-	/* ___Adding the .am extension to the file's name___ */
+	/* ___Adding the .am extension to the file's name, for diagnostics___ */
 	if ((ipName = add_ext(baseName, ".am")) == NULL)
 	{
 		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
 		return QUIT_UPON_ERROR;
 	}
 
-	/* ___Opening the file___ */
-	if ((ip = fopen(ipName, "r")) == NULL)
-	{
-		err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], NULL);
-		FP_CLOSE
-		return QUIT_UPON_ERROR;
-	}
-
-	while (fgets(sourceLine, MAX_LINE_LENGTH + 1, ip) != NULL)
+	/* ___Processing the macro-expanded lines, until there are as many errors as are kept___ */
+	while (lineIndex < amLines->count && !DIAG_LIMIT_REACHED(diags))
 	{
+		/* the line is scanned once, the steps below work on its tokens */
+		line.start = LINE_AT(amLines, lineIndex);
+		line.len = strlen(line.start);
+		tokenize_line(&line, &tokens);
 		lineIndex++;
-		/* copying the sourceLine to lineCopy to avoid it being changed by strtok */
-		strcpy(lineCopy, sourceLine);
-
-		/* tempWord will initially hold the first token of the line, which will be identified by the first_token_proc function */
-		tempWord = strtok(lineCopy, DELIM);
 
 		/* checking if the first token is a label */
-		if (tempWord[strlen(tempWord) - 1] == ':')
+		if (tokens.label.text != NULL)
 		{
-			tempWord[strlen(tempWord) - 1] = '\0';
-
-			funcRes = valid_label(ERR_DETAILS, tempWord, resNames, TRUE, head);
+			funcRes = valid_label(ERR_DETAILS, tokens.label.text, resNames, TRUE, symbols);
 			if (funcRes == FUNC_ERROR)
 			{
 				FP_CLOSE
@@ -85,13 +70,10 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 			}
 
 			foundLabelFlag = TRUE;
-			currentLabelName = tempWord;
-
-			/* tempWord will hold the next token */
-			tempWord = strtok(NULL, DELIM);
+			currentLabelName = tokens.label.text;
 		}
 
-		funcRes = find_element_type(ERR_DETAILS, tempWord, dirList, ocList);
+		funcRes = find_element_type(ERR_DETAILS, tokens.element.text, dirList, ocList);
 
 		/* the element is an instruction/opcode according to the index range */
 		if (funcRes >= 0 && funcRes < Element_instructionEnd)
@@ -102,7 +84,7 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 
 			currentSymbolType = symbolType_code;
 			currentSymbolVal = IC + IMAGE_OFFSET;
-			funcRes = process_opcode(ERR_DETAILS, ocList[funcRes], sourceLine, foundLabelFlag, head, &nlHead,
+			funcRes = process_opcode(ERR_DETAILS, ocList[funcRes], &tokens, foundLabelFlag, symbols, fixups,
 									 resNames, codeImage, &IC);
 		}
 
@@ -114,9 +96,9 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 				labelIsEntryFlag = ENTRY_FROM_DIR;
 
 			currentSymbolType = symbolType_data;
-			currentSymbolVal = DC;
-			funcRes = process_dir(ERR_DETAILS, dirList[funcRes - (Element_instructionEnd + 1)], sourceLine, foundLabelFlag, &head,
-								  resNames, &myDataImage, &DC);
+			currentSymbolVal = data->count;
+			funcRes = process_dir(ERR_DETAILS, dirList[funcRes - (Element_instructionEnd + 1)], &tokens, foundLabelFlag, symbols,
+								  resNames, data);
 		}
 
 		if (funcRes == FUNC_ERROR)
@@ -124,11 +106,11 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 
 		else if (labelIsEntryFlag)
 		{
-			symbolNode *toUpdate = is_symbol(head, currentLabelName);
+			symbolEntry *toUpdate = is_symbol(symbols, currentLabelName);
 
 			if (toUpdate == NULL)
 			{
-				err_with_line(ERR_DETAILS, fpErrList[FP_ERR_INVALID_ENTRY], tempWord);
+				err_with_line(ERR_DETAILS, fpErrList[FP_ERR_INVALID_ENTRY], tokens.element.text);
 				foundErrorFlag = TRUE;
 				continue;
 			}
@@ -142,8 +124,7 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 		}
 		else if (foundLabelFlag)
 		{
-			head = new_symbol(stage, currentLabelName, currentSymbolType, currentSymbolVal, RELOCATABLE, head);
-			if (head == NULL)
+			if (new_symbol(stage, currentLabelName, currentSymbolType, currentSymbolVal, RELOCATABLE, symbols) == NULL)
 			{
 				err_with_line(ERR_DETAILS, fpErrList[FP_ERR_SYMB_ADD], NULL);
 				FP_CLOSE
@@ -152,22 +133,27 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 		}
 
 		/* preparing for the next iteration */
-		strcpy(sourceLine, ""); /* clearing the sourceLine */
 		currentLabelName = NULL;
 		foundLabelFlag = FALSE;
 		labelIsEntryFlag = FALSE;
 		funcRes = 0;
+	}
 
-		if (feof(ip))
-			break;
+	/* the data image is placed after the code image, and both must fit in the memory */
+	if (IC + data->count > IMAGE_WORDS)
+	{
+		err_wo_line(stage, fpErrList[FP_ERR_IMAGE_FULL], ipName);
+		foundErrorFlag = TRUE;
 	}
 
 	/* update the data symbols' values */
 	{
-		symbolNode *currentNode = head;
+		int index;
 
-		while (currentNode != NULL)
+		for (index = 0; index < symbols->count; index++)
 		{
+			symbolEntry *currentNode = &symbols->entries[index];
+
 			if (currentNode->type == symbolType_data)
 				currentNode->value += (IC + IMAGE_OFFSET);
 			else if (currentNode->type == symbolType_entryDir)
@@ -175,25 +161,9 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 				currentNode->value += (IC + IMAGE_OFFSET);
 				currentNode->type = symbolType_entry;
 			}
-
-			currentNode = currentNode->next;
 		}
 	}
 
-	temp = (short int *)realloc(myDataImage, (DC + 1) * sizeof(short int));
-	if (temp == NULL)
-	{
-		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
-		return FUNC_ERROR;
-	}
-	*dataImage = myDataImage = temp;
-	temp = NULL;
-
-	myDataImage[DC] = PLACEHOLDER;
-
-	*symbolHead = head;
-	*needLHead = nlHead;
-	*dataImage = myDataImage;
 	FP_CLOSE
 
 	if (foundErrorFlag)
@@ -204,183 +174,351 @@ int first_pass(char *baseName, char *resNames, short int codeImage[], short int
 
 /* ___Helper functions___ */
 
-/* A function that receives a full assembly line,
-   and ensures that the tokens are separated by commas properly.
+/* Copies a token into a line's record.
    Parameters:
-   - ERR_DETAILS_SIG: Error details such as stage, line index, etc.
-   - toCheck: The assembly line string to check for token separation.
+   - next: Points to the next free character of the record, advanced past the copy.
+   - start: The token's first character in the line.
+   - len: The token's length.
+   - toSet: The token to set.
+*/
+void copy_token(char **next, const char *start, int len, token *toSet)
+{
+	memcpy(*next, start, len);
+	(*next)[len] = '\0';
 
-   Returns:
-   - -1 (FUNC_ERROR) if the string is not structured properly.
-   - 0+ (TRUE) indicating the number of arguments if the string is structured properly.
+	toSet->text = *next;
+	toSet->len = len;
+
+	*next += len + 1;
+}
+
+/* A function that breaks a full assembly line into its label, element and arguments,
+   and finds how the arguments are separated by commas, all in a single scan of the line.
+   Parameters:
+   - line: The assembly line, which is scanned in place and not changed.
+   - tokens: The record to fill.
+
+   Notes:
+   - The first token is a label if it ends with ':', the element is the token that follows it.
+   - A comma error is the first point in which there are more commas than arguments,
+	 or two arguments without a comma between them. A comma following the last argument is checked last.
 */
-int is_valid_line(ERR_DETAILS_SIG, char *sourceLine, int foundLabelFlag)
+void tokenize_line(const lineSlice *line, lineRecord *tokens)
 {
-	int index,
-		len,
-		tokenC = 0,		  /* counter of tokens */
-		commaC = 0,		  /* counter of commas */
-		newTokenF = TRUE; /* flag indicating that a new token is expected after a comma or a white space */
+	const char *current = line->start,
+		*start,
+		*end = line->start + line->len;
+
+	char *next = tokens->text;
+
+	int tokenC = 0, /* counter of tokens */
+		commaC = 0; /* counter of commas */
+
+	tokens->label.text = tokens->element.text = NULL;
+	tokens->label.len = tokens->element.len = 0;
+	tokens->args.start = NULL;
+	tokens->args.len = 0;
+	tokens->operandCount = 0;
+	tokens->commaErr = NO_COMMA_ERR;
+
+	/* the first token */
+	while (current < end && isspace((unsigned char)*current))
+		current++;
+	for (start = current; current < end && !isspace((unsigned char)*current); current++)
+		;
+	if (current == start)
+		return;
+
+	/* the first token is a label, the element follows it */
+	if (current[-1] == ':')
+	{
+		copy_token(&next, start, current - start - 1, &tokens->label);
+
+		while (current < end && isspace((unsigned char)*current))
+			current++;
+		for (start = current; current < end && !isspace((unsigned char)*current); current++)
+			;
+		if (current == start)
+			return;
+	}
+	copy_token(&next, start, current - start, &tokens->element);
 
-	char current,
-		*toCheck,
-		lineCopy[MAX_LINE_LENGTH + 1];
+	/* the arguments, without the surrounding white spaces */
+	while (current < end && isspace((unsigned char)*current))
+		current++;
+	if (current == end)
+		return;
 
-	/* copying to toCheck as to not change the source line */
-	strcpy(lineCopy, sourceLine);
-	toCheck = lineCopy;
+	for (; isspace((unsigned char)end[-1]); end--)
+		;
+	tokens->args.start = current;
+	tokens->args.len = end - current;
 
-	if (foundLabelFlag)
+	/* separating the arguments, and checking the validity of the commaC, tokenC difference */
+	while (current < end)
 	{
-		toCheck = remove_edge_ws(toCheck);
-		toCheck = strpbrk(toCheck, DELIM); /* points to the first white space following the label */
+		if (*current == ',')
+		{
+			commaC++;
+			current++;
+		}
+		else if (isspace((unsigned char)*current))
+		{
+			current++;
+			continue;
+		}
+		else
+		{
+			for (start = current; current < end && *current != ',' && !isspace((unsigned char)*current); current++)
+				;
+			if (tokens->operandCount < MAX_LINE_TOKENS)
+				copy_token(&next, start, current - start, &tokens->operands[tokens->operandCount++]);
+			tokenC++;
+		}
+
+		if (tokens->commaErr == NO_COMMA_ERR)
+		{
+			if (commaC > tokenC)
+				tokens->commaErr = FP_ERR_ILLEGAL_COMMA;
+			else if (tokenC - commaC > 1)
+				tokens->commaErr = FP_ERR_MISSING_COMMA;
+		}
 	}
+	if (tokens->commaErr == NO_COMMA_ERR && commaC == tokenC)
+		tokens->commaErr = FP_ERR_LAST_ARG_COMMA;
+}
+
+/* A function that ensures that the arguments of a tokenized line are separated by commas properly.
+   Parameters:
+   - ERR_DETAILS_SIG: Error details such as stage, line index, etc.
+   - tokens: The tokenized line.
+
+   Returns:
+   - -1 (FUNC_ERROR) if the line is not structured properly.
+   - 0+ (TRUE) indicating the number of arguments if the line is structured properly.
+*/
+int is_valid_line(ERR_DETAILS_SIG, lineRecord *tokens)
+{
+	if (tokens->commaErr != NO_COMMA_ERR)
+	{
+		err_with_line(ERR_DETAILS, fpErrList[tokens->commaErr], NULL);
+		return FUNC_ERROR;
+	}
+
+	return tokens->operandCount;
+}
+
+/* Appends an entry for a name to the symbol table, growing the table if needed.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - name: The name of the symbol.
+   - symbols: The symbol table.
+
+   Returns:
+   - 0+: The index of the new entry, whose fields are left for the caller to set.
+   - -1 (FUNC_ERROR) if memory allocation fails.
 
-	toCheck = remove_edge_ws(toCheck);
-	toCheck = strpbrk(toCheck, DELIM); /* points to the first white space following the element */
-	toCheck = remove_edge_ws(toCheck); /* points to the first arg */
+   Notes:
+   - The entries array and the hash index are doubled when full, the hash index is kept at most half full.
+*/
+int add_symbol_entry(const errStage *stage, char *name, symbolTable *symbols)
+{
+	int id = intern_name(symbols->names, name);
 
-	if (toCheck == NULL)
+	if (id == FUNC_ERROR)
 	{
-		return tokenC; /* 0 arguments */
+		err_wo_line(stage, fpErrList[FP_ERR_SYMB_ADD], name);
+		return FUNC_ERROR;
 	}
 
-	len = strlen(toCheck);
-	for (index = 0; index < len; index++)
+	/* growing the entries array, along with the definition order array */
+	if (symbols->count == symbols->capacity)
 	{
-		current = toCheck[index];
+		int newCapacity = (symbols->capacity == 0) ? SYMBOL_TABLE_INIT_SIZE : symbols->capacity * 2;
 
-		if (!isspace(current))
-		{
-			/* the char is the beginning of a new token */
-			if (current != ',')
-			{
-				if (newTokenF)
-				{
-					tokenC++;
-					newTokenF = FALSE;
-				}
-			}
-			/* found a comma, expecting to get a new token */
-			else
-			{
-				commaC++;
-				newTokenF = TRUE;
-			}
-		}
-		else
-			newTokenF = TRUE;
+		symbolEntry *temp = (symbolEntry *)realloc(symbols->entries, newCapacity * sizeof(symbolEntry));
+		int *tempOrder;
 
-		/* checking the validity of the commaC, tokenC difference */
-		if (commaC > tokenC)
+		if (temp == NULL)
 		{
-			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_ILLEGAL_COMMA], NULL);
+			err_wo_line(stage, fpErrList[FP_ERR_SYMB_ADD], name);
 			return FUNC_ERROR;
 		}
-		else if (tokenC - commaC > 1)
+		symbols->entries = temp;
+
+		if ((tempOrder = (int *)realloc(symbols->defOrder, newCapacity * sizeof(int))) == NULL)
 		{
-			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_MISSING_COMMA], NULL);
+			err_wo_line(stage, fpErrList[FP_ERR_SYMB_ADD], name);
 			return FUNC_ERROR;
 		}
+		symbols->defOrder = tempOrder;
+		symbols->capacity = newCapacity;
 	}
-	if (commaC == tokenC)
+
+	/* growing the hash index, and rehashing the existing entries */
+	if ((symbols->count + 1) * 2 > symbols->slotCount)
 	{
-		err_with_line(ERR_DETAILS, fpErrList[FP_ERR_LAST_ARG_COMMA], NULL);
-		return FUNC_ERROR;
+		int index,
+			newSlotCount = (symbols->slotCount == 0) ? 2 * SYMBOL_TABLE_INIT_SIZE : symbols->slotCount * 2;
+
+		int *temp = (int *)malloc(newSlotCount * sizeof(int));
+		if (temp == NULL)
+		{
+			err_wo_line(stage, fpErrList[FP_ERR_SYMB_ADD], name);
+			return FUNC_ERROR;
+		}
+		free(symbols->slots);
+		symbols->slots = temp;
+		symbols->slotCount = newSlotCount;
+
+		for (index = 0; index < newSlotCount; index++)
+			symbols->slots[index] = EMPTY_SLOT;
+
+		for (index = 0; index < symbols->count; index++)
+			symbols->slots[symbol_slot(symbols, symbols->entries[index].name)] = index;
 	}
 
-	return tokenC;
+	symbols->entries[symbols->count].name = id;
+	symbols->slots[symbol_slot(symbols, id)] = symbols->count;
+
+	return symbols->count++;
 }
 
-/* Creates a new symbol node with the given parameters.
+/* Defines a new symbol with the given parameters in the symbol table.
    Parameters:
    - stage: The stage in which the error occurred.
    - name: The name of the symbol.
    - type: The type of the symbol.
    - value: The value associated with the symbol.
-   - next: Pointer to the next symbol node in the linked list.
+   - ARE: The A, R, E value of the symbol.
+   - symbols: The symbol table.
 
    Returns:
-   - A pointer to the head of the symbol list.
-   - NULL if memory allocation for the new node fails.
+   - A pointer to the symbol's entry (valid until the next symbol is added).
+   - NULL if memory allocation for the new entry fails.
+
+   Notes:
+   - If the label was used before its definition, its placeholder entry is the one being defined.
 */
-symbolNode *new_symbol(const char *stage, char *name, int type, int value, int ARE, symbolNode *head)
+symbolEntry *new_symbol(const errStage *stage, char *name, int type, int value, int ARE, symbolTable *symbols)
 {
-	/* new node */
-	symbolNode *current,
-		*newNode = (symbolNode *)malloc(sizeof(symbolNode));
+	symbolEntry *newEntry;
 
-	if (newNode == NULL)
-	{
-		err_wo_line(stage, fpErrList[FP_ERR_SYMB_ADD], name);
+	int index = symbol_index(symbols, name);
+
+	if (index == EMPTY_SLOT && (index = add_symbol_entry(stage, name, symbols)) == FUNC_ERROR)
 		return NULL;
-	}
 
-	strcpy(newNode->symbolName, name);
-	newNode->type = type;
-	newNode->value = value;
-	newNode->ARE = ARE;
-	newNode->next = NULL;
+	newEntry = &symbols->entries[index];
+	newEntry->type = type;
+	newEntry->value = value;
+	newEntry->ARE = ARE;
 
-	if (head == NULL)
-		/* the list is empty, return the new node */
-		return newNode;
+	symbols->defOrder[symbols->defCount++] = index;
 
-	/* traverse the list to find the last node */
-	current = head;
-	while (current->next != NULL)
-	{
-		current = current->next;
-	}
+	return newEntry;
+}
 
-	current->next = newNode;
+/* Finds the symbol table entry of a label used as an operand,
+   adding a placeholder entry if the label was not defined yet.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - name: The name of the label.
+   - symbols: The symbol table.
 
-	return head;
+   Returns:
+   - 0+: The index of the label's entry.
+   - -1 (FUNC_ERROR) if memory allocation for the placeholder fails.
+*/
+int symbol_ref(const errStage *stage, char *name, symbolTable *symbols)
+{
+	int index = symbol_index(symbols, name);
+
+	if (index != EMPTY_SLOT)
+		return index;
+
+	if ((index = add_symbol_entry(stage, name, symbols)) == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	symbols->entries[index].type = symbolType_pending;
+	symbols->entries[index].value = 0;
+	symbols->entries[index].ARE = RELOCATABLE;
+
+	return index;
 }
 
-/* Creates a new "need label" node (for the second pass) with the given parameters.
+/* Records a code image cell that needs a label's address, to be patched in the second pass.
    Parameters:
    - stage: The stage in which the error occurred.
    - name: The name of the label needed.
-   - location: IC+100
-   - next: Pointer to the next symbol node in the linked list.
+   - location: The IC of the cell (IMAGE_OFFSET will be added).
+   - readInLine: The line in which the label was used.
+   - symbols: The symbol table.
+   - fixups: The fixup table.
 
    Returns:
-   - A pointer to the head of the "need label" list.
-   - NULL if memory allocation for the new node fails.
+   - 1 (TRUE) if the fixup was recorded.
+   - -1 (FUNC_ERROR) if memory allocation fails.
 */
-needLabelNode *new_need_label(const char *stage, char *name, int location, int readInLine, needLabelNode *head)
+int new_fixup(const errStage *stage, char *name, int location, int readInLine, symbolTable *symbols, fixupTable *fixups)
 {
-	/* new node */
-	needLabelNode *current,
-		*newNode = (needLabelNode *)malloc(sizeof(needLabelNode));
+	fixup *newFixup;
+
+	int symbol = symbol_ref(stage, name, symbols);
 
-	if (newNode == NULL)
+	if (symbol == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	/* growing the fixup array */
+	if (fixups->count == fixups->capacity)
 	{
-		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		int newCapacity = (fixups->capacity == 0) ? FIXUP_TABLE_INIT_SIZE : fixups->capacity * 2;
 
-		return NULL;
+		fixup *temp = (fixup *)realloc(fixups->items, newCapacity * sizeof(fixup));
+		if (temp == NULL)
+		{
+			err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+			return FUNC_ERROR;
+		}
+		fixups->items = temp;
+		fixups->capacity = newCapacity;
 	}
 
-	strcpy(newNode->labelName, name);
-	newNode->IC = location + 100;
-	newNode->readInLine = readInLine;
-	newNode->next = NULL;
+	newFixup = &fixups->items[fixups->count++];
+	newFixup->symbol = symbol;
+	newFixup->IC = location + IMAGE_OFFSET;
+	newFixup->readInLine = readInLine;
 
-	if (head == NULL)
-		/* the list is empty, set the new node as the head */
-		return newNode;
+	return TRUE;
+}
+
+/* Makes room in the data image for more words, doubling its capacity as needed.
+   Parameters:
+   - data: The data image.
+   - count: The number of words to make room for.
 
-	/* traverse the list to find the last node */
-	current = head;
-	while (current->next != NULL)
+   Returns:
+   - 1 (TRUE) if there is enough room.
+   - -1 (FUNC_ERROR) if memory allocation fails.
+*/
+int reserve_data(dataBuffer *data, int count)
+{
+	if (data->count + count > data->capacity)
 	{
-		current = current->next;
-	}
+		int newCapacity = (data->capacity == 0) ? DATA_IMAGE_INIT_SIZE : data->capacity;
+
+		short int *temp;
 
-	current->next = newNode;
+		while (data->count + count > newCapacity)
+			newCapacity *= 2;
 
-	return head;
+		if ((temp = (short int *)realloc(data->words, newCapacity * sizeof(short int))) == NULL)
+			return FUNC_ERROR;
+
+		data->words = temp;
+		data->capacity = newCapacity;
+	}
+	return TRUE;
 }
 
 /* Builds the memory word for an operand, and adds it to the data image array.
@@ -393,27 +531,25 @@ needLabelNode *new_need_label(const char *stage, char *name, int location, int r
    - currentOc: The current opcode being processed.
    - currentOp: The string representing the current operand.
    - currentAddRes: The addressing method code.
-   - head: Pointer to the head of the symbol table.
-   - resNames: The file name for reserved names.
+   - symbols: The symbol table.
+   - resNames: The reserved names index.
 
    Returns:
 	-  1 (TRUE) if the word was successfully made and added.
 	-  0 (FALSE) if the complete word was not yet made, due to addressing method restrictions (which is valid for operands containing labels).
-	- -1 (FUNC_ERROR) if there was a problem adding a need label node.
+	- -1 (FUNC_ERROR) if there was a problem recording a fixup.
 
 	Notes:
 	- 	This function is called only after the line has been conirmed to be valid.
 	-	Thus, it relies on its validity, works while assuming the word's structure is proper, and skips test that were done beforehand.
 
 */
-int build_operand_word(ERR_DETAILS_SIG, short int codeImage[], int *IC, char *currentOp, int currentAddRes, int opType, symbolNode *head, needLabelNode **needLHead)
+int build_operand_word(ERR_DETAILS_SIG, short int codeImage[], int *IC, char *currentOp, int currentAddRes, int opType, symbolTable *symbols, fixupTable *fixups)
 {
 	short int base = 0,
 			  value = 0,
 			  tempValue = INT_FUNC_ERROR; /* if tempValue will not be updated during the operation, it will hold an int that's out of range */
 
-	needLabelNode *nlHead = *needLHead;
-
 	if (currentOp == NULL || currentAddRes == FUNC_ERROR)
 		return FALSE;
 
@@ -422,14 +558,12 @@ int build_operand_word(ERR_DETAILS_SIG, short int codeImage[], int *IC, char *cu
 	case addMethod_direct:
 	{
 		/* label, not known in the first pass */
-		nlHead = new_need_label(stage, currentOp, (*IC), lineIndex, nlHead);
-		if (nlHead == NULL)
+		if (new_fixup(stage, currentOp, (*IC), lineIndex, symbols, fixups) == FUNC_ERROR)
 		{
-			err_wo_line(stage, fpErrList[FP_ERR_NL_ADD], NULL);
+			err_wo_line(stage, fpErrList[FP_ERR_FIXUP_ADD], NULL);
 			return FUNC_ERROR;
 		}
 		(*IC)++; /* save space for this label's code in the code image  will be updated in the second pass */
-		*needLHead = nlHead;
 		return FALSE;
 	}
 	case addMethod_directReg:
@@ -460,14 +594,12 @@ int build_operand_word(ERR_DETAILS_SIG, short int codeImage[], int *IC, char *cu
 		/* finding the first word - label, not known in the first pass */
 		labelName = currentOp;
 
-		nlHead = new_need_label(stage, labelName, (*IC), lineIndex, nlHead);
-		if (nlHead == NULL)
+		if (new_fixup(stage, labelName, (*IC), lineIndex, symbols, fixups) == FUNC_ERROR)
 		{
-			err_wo_line(stage, fpErrList[FP_ERR_NL_ADD], NULL);
+			err_wo_line(stage, fpErrList[FP_ERR_FIXUP_ADD], NULL);
 			return FUNC_ERROR;
 		}
 		(*IC)++;
-		*needLHead = nlHead;
 		currentOp = inBrackets;
 		/* no break, the rest is the same as the next case */
 	}
@@ -479,7 +611,7 @@ int build_operand_word(ERR_DETAILS_SIG, short int codeImage[], int *IC, char *cu
 		/* (in constInd addressing - '[' turned '\0') */
 		currentOp++;
 
-		tempValue = int_from_abs_arg(currentOp, head);
+		tempValue = int_from_abs_arg(currentOp, symbols);
 
 		if (tempValue < INT_FUNC_ERROR)
 		{
@@ -506,31 +638,30 @@ int build_operand_word(ERR_DETAILS_SIG, short int codeImage[], int *IC, char *cu
    - currentOc: The current opcode being processed.
    - destOp: The destination operand string.
    - srcOp: The source operand string.
-   - head: Pointer to the head of the symbol table.
-   - resNames: The file name for reserved names.
+   - symbols: The symbol table.
+   - resNames: The reserved names index.
 
    Returns:
    - TRUE if the machine code words were successfully built.
    - FUNC_ERROR (-1) if an error occurred during processing.
 */
-int first_pass_binary(ERR_DETAILS_SIG, short int codeImage[], int *IC, Opcodes currentOc, char *destOp, char *srcOp, symbolNode *head, needLabelNode **needLHead, char *resNames)
+int first_pass_binary(ERR_DETAILS_SIG, short int codeImage[], int *IC, Opcodes currentOc, char *destOp, char *srcOp, symbolTable *symbols, fixupTable *fixups, resNamesIndex *resNames)
 {
 	short int base = 0;
 
 	int destAddRes = 0,
-		srcAddRes = 0;
-
-	needLabelNode *nlHead = *needLHead;
+		srcAddRes = 0,
+		words;
 
 	/* finding the operands' addressing methods, and checking their validity */
 	if (srcOp != NULL)
 	{
 		/* finding the addressing method of the source operand */
-		srcAddRes = find_addressing(ERR_DETAILS, srcOp, head, resNames, TRUE);
+		srcAddRes = find_addressing(ERR_DETAILS, srcOp, symbols, resNames, TRUE);
 		if (srcAddRes == FUNC_ERROR)
 			return FUNC_ERROR;
 
-		if (currentOc.srcOpAdd[srcAddRes] == FALSE)
+		if (!(srcAddMask[currentOc.index] & (1 << srcAddRes)))
 		{
 			/* the source operand is using an addressing method that's not allowed for this opcode */
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_ILLEGAL_ADD_METHOD], srcOp);
@@ -540,11 +671,11 @@ int first_pass_binary(ERR_DETAILS_SIG, short int codeImage[], int *IC, Opcodes c
 
 	if (destOp != NULL)
 	{
-		destAddRes = find_addressing(ERR_DETAILS, destOp, head, resNames, TRUE);
+		destAddRes = find_addressing(ERR_DETAILS, destOp, symbols, resNames, TRUE);
 		if (destAddRes == FUNC_ERROR)
 			return FUNC_ERROR;
 
-		if (currentOc.destOpAdd[destAddRes] == FALSE)
+		if (!(destAddMask[currentOc.index] & (1 << destAddRes)))
 		{
 			/* the destination operand is using an addressing method that's not allowed for this opcode */
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_ILLEGAL_ADD_METHOD], destOp);
@@ -552,13 +683,16 @@ int first_pass_binary(ERR_DETAILS_SIG, short int codeImage[], int *IC, Opcodes c
 		}
 	}
 
-	/* building the first word using the information we have on the opcode, and addressing methods */
-	base |= currentOc.index << OPCODE_MOVE;
-	base |= srcAddRes << SRC_OP_MOVE;
-	base |= destAddRes << DEST_OP_MOVE;
+	/* the line's words must fit in the memory - a constant index takes two words, and two registers share one */
+	words = (srcAddRes == addMethod_directReg && destAddRes == addMethod_directReg) ? 2 : 1 + operand_words(srcOp, srcAddRes) + operand_words(destOp, destAddRes);
+	if (*IC + words > IMAGE_WORDS)
+	{
+		err_with_line(ERR_DETAILS, fpErrList[FP_ERR_IMAGE_FULL], currentOc.name);
+		return FUNC_ERROR;
+	}
 
-	/* adding the first word to the data image */
-	codeImage[IMAGE_OFFSET + (*IC)++] = base;
+	/* the first word is determined by the opcode and addressing methods alone */
+	codeImage[IMAGE_OFFSET + (*IC)++] = firstWordTemplate[currentOc.index][srcAddRes][destAddRes];
 
 	/* building the next words */
 	base = 0;
@@ -575,23 +709,36 @@ int first_pass_binary(ERR_DETAILS_SIG, short int codeImage[], int *IC, Opcodes c
 	}
 
 	/* building the words of the individual operands */
-	build_operand_word(ERR_DETAILS, codeImage, IC, srcOp, srcAddRes, opType_srcOp, head, &nlHead);
-	build_operand_word(ERR_DETAILS, codeImage, IC, destOp, destAddRes, opType_destOp, head, &nlHead);
-
-	*needLHead = nlHead;
+	build_operand_word(ERR_DETAILS, codeImage, IC, srcOp, srcAddRes, opType_srcOp, symbols, fixups);
+	build_operand_word(ERR_DETAILS, codeImage, IC, destOp, destAddRes, opType_destOp, symbols, fixups);
 
 	return TRUE;
 }
 
+/* Counts the words of an operand, after the first word of its line.
+   Parameters:
+   - op: The operand, or NULL if there is none.
+   - addMethod: Its addressing method.
+
+   Returns:
+   - The number of words.
+*/
+int operand_words(char *op, int addMethod)
+{
+	if (op == NULL)
+		return 0;
+	return (addMethod == addMethod_constInd) ? 2 : 1;
+}
+
 /* Processes an opcode line, handling label definitions, operand validation, and generating machine code that goes into the codeImage array.
 	Parameters:
 	- ERR_DETAILS_SIG: Signature for error details.
 	- currentOc: Opcode structure representing the current opcode.
-	- currentLine: The current line being processed.
+	- tokens: The tokens of the current line.
 	- foundLabelFlag: Flag indicating whether a label was found in the line.
-	- head: Pointer to the symbol node head.
-	- needLHead: Pointer to the head of the list of needed labels.
-	- resNames: Reserved names file name.
+	- symbols: The symbol table.
+	- fixups: The table of code image cells that need labels.
+	- resNames: The reserved names index.
 	- codeImage: Array to store the generated machine code.
 	- IC: Instruction counter.
 
@@ -604,16 +751,12 @@ int first_pass_binary(ERR_DETAILS_SIG, short int codeImage[], int *IC, Opcodes c
 	- Validates the number of operands against the instructions's requirements.
 	- Uses helper function from the general library included.
 */
-int process_opcode(ERR_DETAILS_SIG, Opcodes currentOc, char *currentLine, int foundLabelFlag, symbolNode *head, needLabelNode **needLHead, char *resNames, short int codeImage[], int *IC)
+int process_opcode(ERR_DETAILS_SIG, Opcodes currentOc, lineRecord *tokens, int foundLabelFlag, symbolTable *symbols, fixupTable *fixups, resNamesIndex *resNames, short int codeImage[], int *IC)
 {
-	int index,
-		numOfArgs;
-
-	char *tempWord,
-		*destOp = NULL,
-		*srcOp = NULL;
+	int numOfArgs;
 
-	needLabelNode *nlHead = *needLHead;
+	char *destOp = NULL,
+		 *srcOp = NULL;
 
 	if (foundLabelFlag && !currentOc.isLabelAllowed)
 	{
@@ -622,7 +765,7 @@ int process_opcode(ERR_DETAILS_SIG, Opcodes currentOc, char *currentLine, int fo
 		return FUNC_ERROR;
 	}
 
-	numOfArgs = is_valid_line(ERR_DETAILS, currentLine, foundLabelFlag);
+	numOfArgs = is_valid_line(ERR_DETAILS, tokens);
 	if (numOfArgs != currentOc.maxOperands)
 	{
 		if (numOfArgs > currentOc.maxOperands)
@@ -635,36 +778,25 @@ int process_opcode(ERR_DETAILS_SIG, Opcodes currentOc, char *currentLine, int fo
 
 		return FUNC_ERROR;
 	}
-	/* processing the operands */
-	for (index = 0; index < currentOc.maxOperands; index++)
-	{
-		tempWord = strtok(NULL, DELIM_WITH_COMMA);
-
-		if (index == currentOc.maxOperands - 1)
-			/* the destination operand is always the last operand */
-			destOp = tempWord;
-		else
-			srcOp = tempWord;
-	}
+	/* processing the operands - the destination operand is always the last operand */
+	if (numOfArgs > 0)
+		destOp = tokens->operands[numOfArgs - 1].text;
+	if (numOfArgs > 1)
+		srcOp = tokens->operands[0].text;
 
 	/* building the machine code for the opcode's line */
-	first_pass_binary(ERR_DETAILS, codeImage, IC, currentOc, destOp, srcOp, head, &nlHead, resNames);
-
-	*needLHead = nlHead;
-
-	return TRUE;
+	return first_pass_binary(ERR_DETAILS, codeImage, IC, currentOc, destOp, srcOp, symbols, fixups, resNames);
 }
 
 /* Processes a directive line, handling label definitions, operand validation, and data/image generation.
 Parameters:
 	- ERR_DETAILS_SIG: Signature for error details.
 	- currentDir: Directive structure variable representing the current directive.
-	- currentLine: The current line being processed.
+	- tokens: The tokens of the current line.
 	- foundLabelFlag: Flag indicating whether a label was found in the line.
-	- symbolHead: Pointer to the head of the symbol node.
-	- resNames: The reserved names file name.
-	- dataImage: Pointer to the data image array.
-	- DC: Data counter (pointer).
+	- symbols: The symbol table.
+	- resNames: The reserved names index.
+	- data: The data image, whose count is the DC.
 
 Returns:
 	- TRUE if the directive line is processed successfully.
@@ -674,22 +806,17 @@ Notes:
 	- Handles label definitions and checks whether labels are allowed for the directive.
 	- Validates the number of operands against the directive's requirements.
 	- Processes operands and generates data image value (short int) for the directive's line.
-	- Updates the symbol node head and data image array as necessary.
+	- Updates the symbol table and data image array as necessary.
 */
-int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int foundLabelFlag, symbolNode **symbolHead, char *resNames, short int **dataImage, int *DC)
+int process_dir(ERR_DETAILS_SIG, Directives currentDir, lineRecord *tokens, int foundLabelFlag, symbolTable *symbols, resNamesIndex *resNames, dataBuffer *data)
 {
 	int index = 0,
 		tempValue,
 		numOfArgs = 0;
 
-	char *tempWord,
-		*helper = NULL;
-
-	symbolNode *head = *symbolHead,
-			   *tempNode;
+	char *tempWord;
 
-	short int *myDataImage = *dataImage,
-			  *temp = NULL;
+	symbolEntry *tempNode;
 
 	if (foundLabelFlag && !currentDir.isLabelAllowed)
 	{
@@ -700,19 +827,11 @@ int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int f
 
 	/* checking line validity except for types defined using commas */
 	if (currentDir.index != Element_define && currentDir.index != Element_string)
-		numOfArgs = is_valid_line(ERR_DETAILS, currentLine, foundLabelFlag);
+		numOfArgs = is_valid_line(ERR_DETAILS, tokens);
 
 	if (numOfArgs == FUNC_ERROR)
 		return FUNC_ERROR;
 
-	/*setting the currentLine to start after the label, if it exists */
-	if (foundLabelFlag)
-	{
-		currentLine = strchr(currentLine, ':');
-		currentLine++;
-		remove_edge_ws(currentLine);
-	}
-
 	switch (currentDir.index)
 	{
 	case Element_data:
@@ -723,81 +842,72 @@ int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int f
 			return FUNC_ERROR;
 		}
 
-		/* realloc to accommodate new data */
-		temp = (short int *)realloc(myDataImage, ((*DC) + numOfArgs) * sizeof(short int));
-		if (temp == NULL)
+		/* making room for the new data */
+		if (reserve_data(data, numOfArgs) == FUNC_ERROR)
 		{
 			err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
 			return FUNC_ERROR;
 		}
-		*dataImage = myDataImage = temp;
-		temp = NULL;
-
-		/* points to the .data directive */
-		tempWord = strtok(currentLine, DELIM_WITH_COMMA);
 
 		/* tempWord holds the current argument */
 		while (index < numOfArgs)
 		{
 			/* could be an int, or an mdefine */
-			tempWord = strtok(NULL, DELIM_WITH_COMMA);
+			tempWord = tokens->operands[index].text;
 
-			tempValue = int_from_abs_arg(tempWord, head);
-			if (tempValue >= INT_FUNC_ERROR && is_symbol(head, tempWord) == NULL)
+			tempValue = int_from_abs_arg(tempWord, symbols);
+			if (tempValue >= INT_FUNC_ERROR && is_symbol(symbols, tempWord) == NULL)
 			{
 				err_with_line(ERR_DETAILS, fpErrList[FR_ERR_MISSING_DEFINE], tempWord);
 				return FUNC_ERROR;
 			}
 
-			myDataImage[index + (*DC)] = tempValue;
+			data->words[data->count + index] = tempValue;
 
 			index++;
 		}
-		(*DC) += numOfArgs;
+		data->count += numOfArgs;
 		break;
 	}
 	case Element_string:
 	{
-		/* tempWord holds the string inside the parethesis */
-		if ((tempWord = strchr(currentLine, '"')) != NULL)
-		{
-			tempWord++;
-			helper = strchr(tempWord, '"');
+		const char *open = NULL,
+				   *close = NULL;
 
-			if (helper != NULL)
-			{
-				helper[0] = '\0';
-			}
+		/* the string is between the first two quotation marks of the arguments */
+		if (tokens->args.len > 0 && (open = (const char *)memchr(tokens->args.start, '"', tokens->args.len)) != NULL)
+		{
+			open++;
+			close = (const char *)memchr(open, '"', tokens->args.len - (open - tokens->args.start));
 		}
-		if (tempWord == NULL || helper == NULL)
+		if (open == NULL || close == NULL)
 		{
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_INVALID_STRING], NULL);
 			return FUNC_ERROR;
 		}
 
-		numOfArgs = strlen(tempWord) + 1; /* considering the null terminator */
+		numOfArgs = (close - open) + 1; /* considering the null terminator */
 
-		/* realloc to accommodate new data */
-		temp = (short int *)realloc(myDataImage, ((*DC) + numOfArgs) * sizeof(short int));
-		if (temp == NULL)
+		/* making room for the new data */
+		if (reserve_data(data, numOfArgs) == FUNC_ERROR)
 		{
 			err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
 			return FUNC_ERROR;
 		}
-		*dataImage = myDataImage = temp;
-		temp = NULL;
 
 		while (index < numOfArgs - 1)
 		{
-			myDataImage[index + (*DC)] = tempWord[index];
+			data->words[data->count + index] = open[index];
 			index++;
 		}
-		myDataImage[index + (*DC)] = '\0';
-		(*DC) += numOfArgs;
+		data->words[data->count + index] = '\0';
+		data->count += numOfArgs;
 		break;
 	}
 	case Element_entry:
 	{
+		int validlabelRes;
+
 		if (numOfArgs > 1)
 		{
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_EXCESS_OPERANDS], currentDir.name);
@@ -809,24 +919,23 @@ int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int f
 			return FUNC_ERROR;
 		}
 
-		/* points to the .entry directive */
-		tempWord = strtok(currentLine, DELIM);
 		/* points to the label */
-		tempWord = strtok(NULL, DELIM);
+		tempWord = tokens->operands[0].text;
 
-		if (valid_label(ERR_DETAILS, tempWord, resNames, FALSE, head) == FUNC_ERROR)
+		validlabelRes = valid_label(ERR_DETAILS, tempWord, resNames, FALSE, symbols);
+		if (validlabelRes == FUNC_ERROR)
 		{
-			err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], resNames);
+			err_wo_line(stage, fpErrList[FP_ERR_RES_NAMES], NULL);
 			return FUNC_ERROR;
 		}
 
-		if (valid_label(ERR_DETAILS, tempWord, resNames, FALSE, head) == FALSE)
+		if (validlabelRes == FALSE)
 		{
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_INVALID_ENTRY], tempWord);
 			return FUNC_ERROR;
 		}
 
-		tempNode = is_symbol(head, tempWord);
+		tempNode = is_symbol(symbols, tempWord);
 		if (tempNode != NULL)
 		{
 			if (tempNode->type != symbolType_mdefine && tempNode->type != symbolType_extern)
@@ -840,13 +949,11 @@ int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int f
 		else
 		{
 			/* adding the label to the symbol tabel as an entry */
-			head = new_symbol(stage, tempWord, symbolType_entryTemp, PLACEHOLDER, RELOCATABLE, head);
-			if (head == NULL)
+			if (new_symbol(stage, tempWord, symbolType_entryTemp, PLACEHOLDER, RELOCATABLE, symbols) == NULL)
 			{
 				err_with_line(ERR_DETAILS, fpErrList[FP_ERR_SYMB_ADD], NULL);
 				return FUNC_ERROR;
 			}
-			*symbolHead = head;
 		}
 		break;
 	}
@@ -865,12 +972,10 @@ int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int f
 			return FUNC_ERROR;
 		}
 
-		/* points to the .extern directive */
-		tempWord = strtok(currentLine, DELIM);
 		/* points to the label */
-		tempWord = strtok(NULL, DELIM);
+		tempWord = tokens->operands[0].text;
 
-		validlabelRes = valid_label(ERR_DETAILS, tempWord, resNames, TRUE, head);
+		validlabelRes = valid_label(ERR_DETAILS, tempWord, resNames, TRUE, symbols);
 
 		if (validlabelRes != TRUE)
 		{
@@ -878,7 +983,7 @@ int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int f
 			return FUNC_ERROR;
 		}
 
-		tempNode = is_symbol(head, tempWord);
+		tempNode = is_symbol(symbols, tempWord);
 		if (tempNode != NULL)
 		{
 			/* there is an existing symbol with the same name */
@@ -887,58 +992,92 @@ int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int f
 		}
 
 		/* adding the label to the symbol tabel as an extern */
-		head = new_symbol(stage, tempWord, symbolType_extern, 0, EXTERNAL, head);
-		if (head == NULL)
+		if (new_symbol(stage, tempWord, symbolType_extern, 0, EXTERNAL, symbols) == NULL)
 		{
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_SYMB_ADD], NULL);
 			return FUNC_ERROR;
 		}
-		*symbolHead = head;
 		break;
 	}
 	case Element_define:
 	{
-		tempWord = strchr(currentLine, '=');
-		if (tempWord == NULL)
+		const char *equals = NULL,
+				   *argsEnd = tokens->args.start + tokens->args.len,
+				   *valueStart,
+				   *nameEnd;
+
+		/* the value follows the '=', the name is the first token preceding it */
+		char value[MAX_LINE_LENGTH + 1],
+			name[MAX_LINE_LENGTH + 1];
+
+		if (tokens->args.len > 0)
+			equals = (const char *)memchr(tokens->args.start, '=', tokens->args.len);
+		if (equals == NULL)
 		{
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_INVALID_DEFINE], NULL);
 			return FUNC_ERROR;
 		}
-		tempWord[0] = '\0';
-		tempWord++; /* now points on the right side of the '=' symbol */
 
-		tempValue = int_from_abs_arg(tempWord, head);
+		/* the arguments end without white spaces, only the ones following the '=' are skipped */
+		for (valueStart = equals + 1; valueStart < argsEnd && isspace((unsigned char)*valueStart); valueStart++)
+			;
+		index = argsEnd - valueStart;
+		memcpy(value, valueStart, index);
+		value[index] = '\0';
+
+		tempValue = int_from_abs_arg(value, symbols);
 		if (tempValue > MAX_DIR_NUM || tempValue < MIN_DIR_NUM)
 		{
-			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_INVALID_DEFINE_VAL], tempWord);
+			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_INVALID_DEFINE_VAL], value);
 			return FUNC_ERROR;
 		}
 
-		/* points to the .define directive */
-		tempWord = strtok(currentLine, DELIM);
+		for (nameEnd = tokens->args.start; nameEnd < equals && !isspace((unsigned char)*nameEnd); nameEnd++)
+			;
+		index = nameEnd - tokens->args.start;
+		memcpy(name, tokens->args.start, index);
+		name[index] = '\0';
 
 		/* points to the label */
-		tempWord = strtok(NULL, DELIM);
+		tempWord = name;
 
-		if (valid_label(ERR_DETAILS, tempWord, resNames, FALSE, head) < TRUE)
+		if (valid_label(ERR_DETAILS, tempWord, resNames, FALSE, symbols) < TRUE)
 		{
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_INVALID_DEFINE], NULL);
 			return FUNC_ERROR;
 		}
 
-		head = new_symbol(stage, tempWord, symbolType_mdefine, tempValue, ABSOLUTE, head);
-		if (head == NULL)
+		if (new_symbol(stage, tempWord, symbolType_mdefine, tempValue, ABSOLUTE, symbols) == NULL)
 		{
 			err_with_line(ERR_DETAILS, fpErrList[FP_ERR_SYMB_ADD], NULL);
 			return FUNC_ERROR;
 		}
-		*symbolHead = head;
 		break;
 	}
 	default:
 		break;
 	}
-	*symbolHead = head;
-	*dataImage = myDataImage;
 	return TRUE;
 }
+
+/*___Error list___ */
+const char *fpErrList[] =
+{
+	"Could not access the reserved names list",
+	"Label definition is not allowed for the element",
+	"Detected an extranous comma",
+	"Detected a missing comma between arguments",
+	"A comma following the last argument is not allowed",
+	"Too many operands for the element",
+	"Missing operands for the element",
+	"Unsuccessful symbol addition attempt for",
+	"The following operand's addressing method is not allowed for this opcode",
+	"Could not define the following symbol as an entry",
+	"Could not define the following symbol as an extern",
+	"Invalid define attempt",
+	"The following value is invalid as a define operand",
+	"Invalid string was given as an argument",
+	"Unsuccessful fixup addition attempt",
+	"The following element is not a number, nor a known define",
+	"The program does not fit in the memory"
+};
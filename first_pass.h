@@ -4,6 +4,7 @@
 
 /* ___Include___ */
 #include "general_lib.h"
+#include "op_tables.h"
 
 /* ___Define___ */
 #define MAX_DIR_NAME 10
@@ -11,16 +12,13 @@
 #define ENTRY_FROM_DIR 1
 #define ENTRY_FROM_OC 2
 
-#define SRC_REG_MOVE 5
-#define DEST_REG_MOVE 2
-#define IMM_OP_MOVE 2
+#define MAX_LINE_TOKENS (MAX_LINE_LENGTH / 2 + 1) /* tokens are separated by at least one character */
+#define NO_COMMA_ERR -1
 
 /* ___Macros___ */
 #define FP_CLOSE            \
 	do                      \
 	{                       \
-		if (ip != NULL)     \
-			fclose(ip);     \
 		if (ipName != NULL) \
 			free(ipName);   \
 	} while (0);
@@ -50,43 +48,52 @@ enum fpErrIndex
 	FP_ERR_INVALID_DEFINE,	   /* There was an Invlid define attempt */
 	FP_ERR_INVALID_DEFINE_VAL, /* define got an invalid value */
 	FP_ERR_INVALID_STRING,	   /* There was an invalid string given as data */
-	FP_ERR_NL_ADD,			   /* Could not properly add a new need label node */
-	FR_ERR_MISSING_DEFINE	   /* Could not find an mdefine in the time of its use */
+	FP_ERR_FIXUP_ADD,		   /* Could not properly record a new fixup */
+	FR_ERR_MISSING_DEFINE,	   /* Could not find an mdefine in the time of its use */
+	FP_ERR_IMAGE_FULL,		   /* The code and data images do not fit in the memory */
+	FP_ERR_END
 
 };
 
-/* ___Constants___ */
-const char *fpErrList[] =
+/* ___Typedef___ */
+/* a token of a line, copied once into the line's record */
+typedef struct token
 {
-	"Could not access the reserved names list",
-	"Label definition is not allowed for the element",
-	"Detected an extranous comma",
-	"Detected a missing comma between arguments",
-	"A comma following the last argument is not allowed",
-	"Too many operands for the element",
-	"Missing operands for the element",
-	"Unsuccessful symbol addition attempt for",
-	"The following operand's addressing method is not allowed for this opcode",
-	"Could not define the following symbol as an entry",
-	"Could not define the following symbol as an extern",
-	"Invalid define attempt",
-	"The following value is invalid as a define operand",
-	"Invalid string was given as an argument",
-	"Unsuccessful need label node addition attempt",
-	"The following element is not a number, nor a known define"
-};
+	char *text; /* null terminated, NULL if the token is missing */
+	int len;
+} token;
+
+/* the structure of a line, found in a single scan by tokenize_line */
+typedef struct lineRecord
+{
+	token label;   /* without the ':' */
+	token element; /* the opcode or directive */
+	lineSlice args; /* the rest of the line, without the surrounding white spaces */
+	token operands[MAX_LINE_TOKENS]; /* args, separated by white spaces and commas */
+	int operandCount;
+	int commaErr; /* the fpErrIndex of the first comma error in args, or NO_COMMA_ERR */
+	char text[2 * (MAX_LINE_LENGTH + 1)]; /* the tokens' characters */
+} lineRecord;
+
+/* ___Constants___ */
+extern const char *fpErrList[];
 
 /* ___Prototypes___*/
-int is_valid_line(ERR_DETAILS_SIG, char *toCheck, int foundLabelFlag);
-symbolNode *new_symbol(const char *stage, char *name, int type, int value, int ARE, symbolNode *head);
-needLabelNode *new_need_label(const char *stage, char *name, int location, int readInLine, needLabelNode *head);
+void tokenize_line(const lineSlice *line, lineRecord *tokens);
+int is_valid_line(ERR_DETAILS_SIG, lineRecord *tokens);
+symbolEntry *new_symbol(const errStage *stage, char *name, int type, int value, int ARE, symbolTable *symbols);
+int add_symbol_entry(const errStage *stage, char *name, symbolTable *symbols);
+int symbol_ref(const errStage *stage, char *name, symbolTable *symbols);
+int new_fixup(const errStage *stage, char *name, int location, int readInLine, symbolTable *symbols, fixupTable *fixups);
+int operand_words(char *op, int addMethod);
 int first_pass_binary(ERR_DETAILS_SIG, short int codeImage[], int *IC, Opcodes currentOc,
-					  char *destOp, char *srcOp, symbolNode *head, needLabelNode **needLHead, char *resNames);
+					  char *destOp, char *srcOp, symbolTable *symbols, fixupTable *fixups, resNamesIndex *resNames);
+int reserve_data(dataBuffer *data, int count);
 int build_operand_word(ERR_DETAILS_SIG, short int codeImage[], int *IC, char *currentOp,
-					   int currentAddRes, int opType, symbolNode *head, needLabelNode **needLHead);
-int process_opcode(ERR_DETAILS_SIG, Opcodes currentOc, char *currentLine, int foundLabelFlag,
-				   symbolNode *head, needLabelNode **needLHead, char *resNames, short int codeImage[], int *IC);
-int process_dir(ERR_DETAILS_SIG, Directives currentDir, char *currentLine, int foundLabelFlag,
-				symbolNode **symbHead, char *resNames, short int **dataImage, int *DC);
+					   int currentAddRes, int opType, symbolTable *symbols, fixupTable *fixups);
+int process_opcode(ERR_DETAILS_SIG, Opcodes currentOc, lineRecord *tokens, int foundLabelFlag,
+				   symbolTable *symbols, fixupTable *fixups, resNamesIndex *resNames, short int codeImage[], int *IC);
+int process_dir(ERR_DETAILS_SIG, Directives currentDir, lineRecord *tokens, int foundLabelFlag,
+				symbolTable *symbols, resNamesIndex *resNames, dataBuffer *data);
 
 #endif
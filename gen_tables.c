@@ -0,0 +1,226 @@
+#include "gen_tables.h"
+
+/* ___The tables generator___ */
+/* Derives the opcode and directive tables used by the assembler from OC_LIST_DEC and DIR_LIST_DEC, at build time:
+   - A perfect hash for classifying mnemonics, searched for among the multipliers of MNEMONIC_HASH.
+   - Bitmasks of the addressing methods allowed for the source and destination operands of every opcode.
+   - The first word of every (opcode, source addressing, destination addressing) combination.
+   - The base 4 encoding of every byte, from which the encoding of a word is put together.
+
+   Usage: gen_tables <header file> <source file>
+*/
+int main(int argc, char *argv[])
+{
+	/* ___Declarations___ */
+	FILE *header = NULL,
+		 *source = NULL;
+
+	mnemonicSlot table[MAX_MNEMONIC_TABLE_SIZE];
+
+	int size,
+		mulFirst = 0,
+		mulSecond = 0,
+		mulLast = 0,
+		found = FALSE,
+		index,
+		symbol,
+		src,
+		dest;
+
+	/* ocList, dirList - the definitions the tables are derived from */
+	OC_LIST_DEC
+	DIR_LIST_DEC
+
+	if (argc != GEN_ARGS)
+	{
+		fprintf(stderr, "Usage: gen_tables <header file> <source file>\n");
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Searching for a perfect hash, starting with the smallest table___ */
+	for (size = MIN_MNEMONIC_TABLE_SIZE; size <= MAX_MNEMONIC_TABLE_SIZE; size *= 2)
+	{
+		if ((found = find_multipliers(table, size, &mulFirst, &mulSecond, &mulLast, ocList, dirList)))
+			break;
+	}
+	if (!found)
+	{
+		fprintf(stderr, "Could not find a perfect hash for the mnemonics.\n");
+		return QUIT_UPON_ERROR;
+	}
+
+	if ((header = fopen(argv[1], "w")) == NULL || (source = fopen(argv[2], "w")) == NULL)
+	{
+		fprintf(stderr, "Could not open the following file: \"%s\".\n", (header == NULL) ? argv[1] : argv[2]);
+		if (header != NULL)
+			fclose(header);
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Writing the header___ */
+	fprintf(header, "/* ___Generated by gen_tables from OC_LIST_DEC and DIR_LIST_DEC - do not edit___ */\n");
+	fprintf(header, "#ifndef OP_TABLES_H\n#define OP_TABLES_H\n\n");
+	fprintf(header, "/* ___Include___ */\n#include \"general_lib.h\"\n\n");
+	fprintf(header, "/* ___Definitions___ */\n");
+	fprintf(header, "#define MNEMONIC_TABLE_SIZE %d\n", size);
+	fprintf(header, "#define MNEMONIC_MUL_FIRST %d\n", mulFirst);
+	fprintf(header, "#define MNEMONIC_MUL_SECOND %d\n", mulSecond);
+	fprintf(header, "#define MNEMONIC_MUL_LAST %d\n\n", mulLast);
+	fprintf(header, "/* ___Constants___ */\n");
+	fprintf(header, "extern const mnemonicSlot mnemonicTable[MNEMONIC_TABLE_SIZE];\n");
+	fprintf(header, "extern const unsigned char srcAddMask[Element_instructionEnd];\n");
+	fprintf(header, "extern const unsigned char destAddMask[Element_instructionEnd];\n");
+	fprintf(header, "extern const short int firstWordTemplate[Element_instructionEnd][ADD_METHODS_NUM][ADD_METHODS_NUM];\n");
+	fprintf(header, "extern const char encodedByte[BYTE_VALUES][BYTE_SYMBOLS];\n\n");
+	fprintf(header, "#endif\n");
+
+	/* ___Writing the tables___ */
+	fprintf(source, "/* ___Generated by gen_tables from OC_LIST_DEC and DIR_LIST_DEC - do not edit___ */\n");
+	fprintf(source, "#include \"op_tables.h\"\n\n");
+
+	/* name, length, element */
+	fprintf(source, "const mnemonicSlot mnemonicTable[MNEMONIC_TABLE_SIZE] =\n{\n");
+	for (index = 0; index < size; index++)
+		fprintf(source, "\t{\"%s\", %d, %d}%s\n", table[index].name, table[index].len, table[index].element,
+				(index < size - 1) ? "," : "");
+	fprintf(source, "};\n\n");
+
+	/* bit n is set if addressing method n is allowed */
+	fprintf(source, "const unsigned char srcAddMask[Element_instructionEnd] =\n{\n");
+	for (index = 0; index < Element_instructionEnd; index++)
+		fprintf(source, "\t0x%X%s /* %s */\n", add_methods_mask(ocList[index].srcOpAdd),
+				(index < Element_instructionEnd - 1) ? "," : "", ocList[index].name);
+	fprintf(source, "};\n\n");
+
+	fprintf(source, "const unsigned char destAddMask[Element_instructionEnd] =\n{\n");
+	for (index = 0; index < Element_instructionEnd; index++)
+		fprintf(source, "\t0x%X%s /* %s */\n", add_methods_mask(ocList[index].destOpAdd),
+				(index < Element_instructionEnd - 1) ? "," : "", ocList[index].name);
+	fprintf(source, "};\n\n");
+
+	/* [opcode][source addressing][destination addressing] */
+	fprintf(source, "const short int firstWordTemplate[Element_instructionEnd][ADD_METHODS_NUM][ADD_METHODS_NUM] =\n{\n");
+	for (index = 0; index < Element_instructionEnd; index++)
+	{
+		fprintf(source, "\t{ /* %s */\n", ocList[index].name);
+		for (src = 0; src < ADD_METHODS_NUM; src++)
+		{
+			fprintf(source, "\t\t{");
+			for (dest = 0; dest < ADD_METHODS_NUM; dest++)
+				fprintf(source, "0x%03X%s", (index << OPCODE_MOVE) | (src << SRC_OP_MOVE) | (dest << DEST_OP_MOVE),
+						(dest < ADD_METHODS_NUM - 1) ? ", " : "");
+			fprintf(source, "}%s\n", (src < ADD_METHODS_NUM - 1) ? "," : "");
+		}
+		fprintf(source, "\t}%s\n", (index < Element_instructionEnd - 1) ? "," : "");
+	}
+	fprintf(source, "};\n\n");
+
+	/* the symbols of a byte, from its 2 leftmost bits to its 2 rightmost bits (not null terminated) */
+	fprintf(source, "const char encodedByte[BYTE_VALUES][BYTE_SYMBOLS] =\n{\n");
+	for (index = 0; index < BYTE_VALUES; index++)
+	{
+		fprintf(source, "\t{");
+		for (symbol = BYTE_SYMBOLS - 1; symbol >= 0; symbol--)
+			fprintf(source, "'%c'%s", BASE4_SYMBOLS[(index >> (2 * symbol)) & 3], (symbol > 0) ? ", " : "");
+		fprintf(source, "}%s\n", (index < BYTE_VALUES - 1) ? "," : "");
+	}
+	fprintf(source, "};\n");
+
+	fclose(header);
+	fclose(source);
+	return SUCCESS;
+}
+
+/* ___Helper functions___ */
+
+/* Searches for hash multipliers that make MNEMONIC_HASH perfect for a given table size.
+   Parameters:
+   - table: The mnemonic table, filled according to the multipliers found.
+   - size: The number of slots (a power of 2).
+   - mulFirst, mulSecond, mulLast: Pointers to the multipliers, set if a perfect hash was found.
+   - ocList: Array of opcode structures.
+   - dirList: Array of directive structures.
+
+   Returns:
+   - 1 (TRUE) if a perfect hash was found.
+   - 0 (FALSE) otherwise.
+*/
+int find_multipliers(mnemonicSlot table[], int size, int *mulFirst, int *mulSecond, int *mulLast,
+					 Opcodes ocList[], Directives dirList[])
+{
+	for (*mulFirst = 1; *mulFirst < size; (*mulFirst)++)
+		for (*mulSecond = 0; *mulSecond < size; (*mulSecond)++)
+			for (*mulLast = 0; *mulLast < size; (*mulLast)++)
+			{
+				if (fill_mnemonic_table(table, size, *mulFirst, *mulSecond, *mulLast, ocList, dirList))
+					return TRUE;
+			}
+	return FALSE;
+}
+
+/* Places every mnemonic in its slot according to the given hash multipliers.
+   Parameters:
+   - table: The mnemonic table to fill.
+   - size: The number of slots (a power of 2).
+   - mulFirst, mulSecond, mulLast: The multipliers of MNEMONIC_HASH.
+   - ocList: Array of opcode structures.
+   - dirList: Array of directive structures.
+
+   Returns:
+   - 1 (TRUE) if there were no collisions, making the hash perfect.
+   - 0 (FALSE) otherwise.
+*/
+int fill_mnemonic_table(mnemonicSlot table[], int size, int mulFirst, int mulSecond, int mulLast,
+						Opcodes ocList[], Directives dirList[])
+{
+	int index,
+		slot,
+		len;
+
+	const char *name;
+
+	for (index = 0; index < size; index++)
+	{
+		strcpy(table[index].name, "");
+		table[index].len = 0;
+		table[index].element = FUNC_ERROR;
+	}
+
+	for (index = 0; index < Element_directiveEnd; index++)
+	{
+		if (index == Element_instructionEnd)
+			continue;
+
+		name = (index < Element_instructionEnd) ? ocList[index].name : dirList[index - Element_instructionEnd - 1].name;
+		len = strlen(name);
+		slot = MNEMONIC_HASH(name, len, mulFirst, mulSecond, mulLast, size);
+
+		if (table[slot].element != FUNC_ERROR)
+			return FALSE; /* collision */
+
+		strcpy(table[slot].name, name);
+		table[slot].len = len;
+		table[slot].element = index;
+	}
+	return TRUE;
+}
+
+/* Converts a string of allowed addressing methods (e.g. "0111") to a bitmask.
+   Parameters:
+   - addMethods: The string, whose n-th character is '1' if addressing method n is allowed.
+
+   Returns:
+   - The bitmask, whose n-th bit is set if addressing method n is allowed.
+*/
+int add_methods_mask(const char *addMethods)
+{
+	int index,
+		mask = 0;
+
+	for (index = 0; index < ADD_METHODS_NUM; index++)
+	{
+		if (addMethods[index] == '1')
+			mask |= 1 << index;
+	}
+	return mask;
+}
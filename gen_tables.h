@@ -0,0 +1,20 @@
+/* ___The tables generator's library___ */
+#ifndef GEN_TABLES_H
+#define GEN_TABLES_H
+
+/* ___Include___ */
+#include "libassembler.h"
+
+/* ___Definitions___ */
+#define GEN_ARGS 3
+#define MIN_MNEMONIC_TABLE_SIZE 32
+#define MAX_MNEMONIC_TABLE_SIZE 256
+
+/* ___Prototypes___*/
+int find_multipliers(mnemonicSlot table[], int size, int *mulFirst, int *mulSecond, int *mulLast,
+					 Opcodes ocList[], Directives dirList[]);
+int fill_mnemonic_table(mnemonicSlot table[], int size, int mulFirst, int mulSecond, int mulLast,
+						Opcodes ocList[], Directives dirList[]);
+int add_methods_mask(const char *addMethods);
+
+#endif
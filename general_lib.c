@@ -1,4 +1,124 @@
 #include "general_lib.h"
+#include "op_tables.h"
+
+/* Copies a string into the characters of a diagnostics list.
+   Parameters:
+   - diags: The list.
+   - string: The string.
+
+   Returns:
+   - The offset of the copy in the list's chars.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int add_diag_str(diagList *diags, const char *string)
+{
+	int len = (int)strlen(string) + 1,
+		offset = diags->size;
+
+	if (diags->size + len > diags->charsCapacity)
+	{
+		int newCapacity = (diags->charsCapacity == 0) ? DIAG_CHARS_INIT_SIZE : diags->charsCapacity;
+		char *temp;
+
+		while (diags->size + len > newCapacity)
+			newCapacity *= 2;
+
+		if ((temp = (char *)realloc(diags->chars, newCapacity)) == NULL)
+			return FUNC_ERROR;
+		diags->chars = temp;
+		diags->charsCapacity = newCapacity;
+	}
+
+	memcpy(diags->chars + offset, string, len);
+	diags->size += len;
+	return offset;
+}
+
+/* Keeps a diagnostic in a list, instead of printing it.
+   Parameters:
+   - diags: The list.
+   - stage: The stage in which the error occurred.
+   - line: The index of the line, or 0.
+   - ipName: The name of the file the line is in, or NULL if it is not about a specific line.
+   - text: The error message text.
+   - specifier: Optional specifier for additional error details.
+
+   Notes:
+   - A diagnostic that could not be kept, for lack of memory or because the list reached its limit, is only counted.
+   - The file's name is kept once for a run of diagnostics of the same file.
+*/
+void add_diagnostic(diagList *diags, const char *stage, int line, char *ipName, const char *text, char *specifier)
+{
+	diagnostic current;
+
+	if (DIAG_LIMIT_REACHED(diags))
+	{
+		diags->dropped++;
+		return;
+	}
+
+	if (diags->count == diags->capacity)
+	{
+		int newCapacity = (diags->capacity == 0) ? DIAG_LIST_INIT_SIZE : diags->capacity * 2;
+
+		diagnostic *temp = (diagnostic *)realloc(diags->items, newCapacity * sizeof(diagnostic));
+		if (temp == NULL)
+		{
+			diags->dropped++;
+			return;
+		}
+		diags->items = temp;
+		diags->capacity = newCapacity;
+	}
+
+	current.stage = stage;
+	current.error = text;
+	current.line = line;
+	current.file = current.specifier = EMPTY_SLOT;
+
+	if (ipName != NULL)
+	{
+		diagnostic *last = (diags->count > 0) ? &diags->items[diags->count - 1] : NULL;
+
+		if (last != NULL && last->file != EMPTY_SLOT && strcmp(diags->chars + last->file, ipName) == 0)
+			current.file = last->file;
+		else if ((current.file = add_diag_str(diags, ipName)) == FUNC_ERROR)
+		{
+			diags->dropped++;
+			return;
+		}
+	}
+	if (specifier != NULL && (current.specifier = add_diag_str(diags, specifier)) == FUNC_ERROR)
+	{
+		diags->dropped++;
+		return;
+	}
+
+	diags->items[diags->count++] = current;
+}
+
+/* Empties a diagnostics list, keeping its memory for the diagnostics of the next file.
+   Parameters:
+   - diags: The list.
+*/
+void clear_diag_list(diagList *diags)
+{
+	diags->count = diags->size = diags->dropped = 0;
+}
+
+/* Frees the memory allocated for a diagnostics list, leaving it empty.
+   Parameters:
+   - diags: The list.
+*/
+void free_diag_list(diagList *diags)
+{
+	free(diags->items);
+	free(diags->chars);
+
+	diags->items = NULL;
+	diags->chars = NULL;
+	diags->count = diags->capacity = diags->size = diags->charsCapacity = diags->dropped = 0;
+}
 
 /* Prints an error message with contextual information about a specific line.
    Parameters:
@@ -8,8 +128,14 @@
    - text: The error message text.
    - specifier: Optional specifier for additional error details.
 */
-void err_with_line(const char *stage, int lineIndex, char *ipName, const char *text, char *specifier)
+void err_with_line(const errStage *stage, int lineIndex, char *ipName, const char *text, char *specifier)
 {
+	if (stage->diags != NULL)
+	{
+		add_diagnostic(stage->diags, stage->name, lineIndex, ipName, text, specifier);
+		return;
+	}
+
 	ERROR_WITH_LINE
 
 	if (specifier != NULL)
@@ -24,8 +150,14 @@ void err_with_line(const char *stage, int lineIndex, char *ipName, const char *t
    - text: The error message text.
    - specifier: Optional specifier for additional error details.
 */
-void err_wo_line(const char *stage, const char *text, char *specifier)
+void err_wo_line(const errStage *stage, const char *text, char *specifier)
 {
+	if (stage->diags != NULL)
+	{
+		add_diagnostic(stage->diags, stage->name, 0, NULL, text, specifier);
+		return;
+	}
+
 	ERROR_WO_LINE
 
 	if (specifier != NULL)
@@ -76,7 +208,7 @@ char *remove_edge_ws(char *string)
 		int len = strlen(string),
 			index = len - 1;
 
-		while (isspace(string[index]) && index > 0)
+		while (index > 0 && isspace(string[index]))
 			index--;
 
 		/* putting a null terminator right after the last non-whitespace char of the string */
@@ -95,63 +227,644 @@ char *remove_edge_ws(char *string)
 	return NULL;
 }
 
-/* A function that checks if a string is a reserved name.
+/* Hashes a name using the FNV-1a scheme.
    Parameters:
-   - toCheck: The string to check.
-   - resNames: The file containing reserved names.
+   - name: The string to hash.
 
    Returns:
-   - -1 (FUNC_ERROR) if the reserved names file could not be opened.
-   - 1 (TRUE) if the string is a reserved name.
-   - 0 (FALSE) if the string is not found in the reserved names file.
+   - The 32 bit hash value of the string.
 */
-int is_reserved_name(char *toCheck, char *resNames)
+unsigned long hash_name(const char *name)
 {
-	char currentLine[MAX_LABEL_LENGTH + 1];
+	unsigned long hash = 2166136261UL;
 
-	FILE *fp = fopen(resNames, "r");
-	if (fp == NULL)
+	while (*name != '\0')
 	{
-		return FUNC_ERROR;
+		hash ^= (unsigned char)*name++;
+		hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
 	}
+	return hash;
+}
 
-	while (fgets(currentLine, MAX_LABEL_LENGTH + 1, fp) != NULL)
+/* Finds the slot of a name in a name set, or the empty slot where it should be placed.
+   Parameters:
+   - slots: The slots of the set.
+   - capacity: The number of slots (a power of 2).
+   - name: The name to look for.
+
+   Returns:
+   - The index of the slot.
+*/
+int name_set_slot(char **slots, int capacity, const char *name)
+{
+	int index = (int)(hash_name(name) & (capacity - 1));
+
+	while (slots[index] != NULL && strcmp(slots[index], name) != 0)
+		index = (index + 1) & (capacity - 1); /* linear probing */
+
+	return index;
+}
+
+/* Adds a copy of a name to a name set, doubling the set when it gets half full.
+   Parameters:
+   - set: The name set.
+   - name: The name to add.
+
+   Returns:
+   - 1 (TRUE) if the name is in the set.
+   - -1 (FUNC_ERROR) if memory allocation failed.
+*/
+int name_set_add(nameSet *set, const char *name)
+{
+	int index;
+
+	if ((set->count + 1) * 2 > set->capacity)
 	{
-		remove_edge_ws(currentLine);
-		if (strcmp(currentLine, toCheck) == 0)
+		int newCapacity = (set->capacity == 0) ? NAME_SET_INIT_SIZE : set->capacity * 2;
+
+		char **newSlots = (char **)calloc(newCapacity, sizeof(char *));
+		if (newSlots == NULL)
+			return FUNC_ERROR;
+
+		/* rehashing the existing names into the new slots */
+		for (index = 0; index < set->capacity; index++)
 		{
-			fclose(fp);
-			return TRUE;
+			if (set->slots[index] != NULL)
+				newSlots[name_set_slot(newSlots, newCapacity, set->slots[index])] = set->slots[index];
 		}
+		free(set->slots);
+		set->slots = newSlots;
+		set->capacity = newCapacity;
 	}
 
-	fclose(fp);
-	return FALSE;
+	index = name_set_slot(set->slots, set->capacity, name);
+	if (set->slots[index] != NULL)
+		return TRUE; /* the name is already in the set */
+
+	if ((set->slots[index] = (char *)malloc(strlen(name) + 1)) == NULL)
+		return FUNC_ERROR;
+
+	strcpy(set->slots[index], name);
+	set->count++;
+	return TRUE;
 }
 
-/* A function that checks if a string is a symbol's name.
+/* Checks whether a name is in a name set.
    Parameters:
-   - head: Pointer to the head of the symbol table linked list.
-   - toCheck: The string to check if it's a symbol's name.
+   - set: The name set.
+   - name: The name to look for.
 
    Returns:
-   - Pointer to the symbol's node if the string is a symbol's name.
-   - NULL if the string is not a symbol's name.
+   - 1 (TRUE) if the name is in the set.
+   - 0 (FALSE) otherwise.
 */
-symbolNode *is_symbol(symbolNode *head, char *toCheck)
+int name_set_has(nameSet *set, const char *name)
 {
-	symbolNode *current = head;
+	if (set->count == 0)
+		return FALSE;
 
-	while (current != NULL)
+	return set->slots[name_set_slot(set->slots, set->capacity, name)] != NULL;
+}
+
+/* Removes all of the names of a name set, keeping its slots for reuse.
+   Parameters:
+   - set: The name set.
+*/
+void name_set_clear(nameSet *set)
+{
+	int index;
+
+	for (index = 0; index < set->capacity && set->count > 0; index++)
+	{
+		if (set->slots[index] != NULL)
+		{
+			free(set->slots[index]);
+			set->slots[index] = NULL;
+			set->count--;
+		}
+	}
+}
+
+/* Frees the memory allocated for a name set.
+   Parameters:
+   - set: The name set.
+*/
+void name_set_free(nameSet *set)
+{
+	name_set_clear(set);
+	free(set->slots);
+	set->slots = NULL;
+	set->capacity = 0;
+}
+
+/* A function that checks if a string is a reserved name.
+   Parameters:
+   - toCheck: The string to check.
+   - resNames: The reserved names index.
+
+   Returns:
+   - -1 (FUNC_ERROR) if the reserved names index is not available.
+   - 1 (TRUE) if the string is a reserved name.
+   - 0 (FALSE) if the string is not found in the reserved names index.
+*/
+int is_reserved_name(char *toCheck, resNamesIndex *resNames)
+{
+	if (resNames == NULL)
+		return FUNC_ERROR;
+
+	return name_set_has(&resNames->base, toCheck) || name_set_has(&resNames->mcrs, toCheck);
+}
+
+/* Finds the slot of a name in a string pool's hash index, or the empty slot where it should be placed.
+   Parameters:
+   - pool: The string pool.
+   - name: The name to look for.
+
+   Returns:
+   - The index of the slot.
+*/
+int pool_slot(stringPool *pool, const char *name)
+{
+	int index = (int)(hash_name(name) & (pool->slotCount - 1));
+
+	while (pool->slots[index] != EMPTY_SLOT && strcmp(POOL_STR(pool, pool->slots[index]), name) != 0)
+		index = (index + 1) & (pool->slotCount - 1); /* linear probing */
+
+	return index;
+}
+
+/* Finds the id of a name that was interned in a string pool.
+   Parameters:
+   - pool: The string pool.
+   - name: The name to look for.
+
+   Returns:
+   - 0+: The id of the name.
+   - -1 (EMPTY_SLOT) if the name was never interned, so it cannot be the name of a symbol or a macro.
+*/
+int find_name(stringPool *pool, const char *name)
+{
+	if (pool == NULL || pool->count == 0)
+		return EMPTY_SLOT;
+
+	return pool->slots[pool_slot(pool, name)];
+}
+
+/* Interns a name in a string pool, storing it only if it is not already there.
+   Parameters:
+   - pool: The string pool.
+   - name: The name to intern.
+
+   Returns:
+   - 0+: The id of the name.
+   - -1 (FUNC_ERROR) if memory allocation failed.
+
+   Notes:
+   - The characters and the hash index are doubled when needed, the hash index is kept at most half full.
+   - The ids stay valid as the pool grows, while pointers returned by POOL_STR do not.
+*/
+int intern_name(stringPool *pool, const char *name)
+{
+	int slot,
+		len = strlen(name) + 1;
+
+	/* growing the hash index, and rehashing the existing names */
+	if ((pool->count + 1) * 2 > pool->slotCount)
 	{
-		if (strcmp(toCheck, current->symbolName) == 0)
+		int index,
+			newSlotCount = (pool->slotCount == 0) ? NAME_SET_INIT_SIZE : pool->slotCount * 2,
+			*oldSlots = pool->slots,
+			oldSlotCount = pool->slotCount;
+
+		if ((pool->slots = (int *)malloc(newSlotCount * sizeof(int))) == NULL)
 		{
-			/* there is a symbol with the same name */
-			return current;
+			pool->slots = oldSlots;
+			return FUNC_ERROR;
 		}
-		current = current->next;
+		pool->slotCount = newSlotCount;
+
+		for (index = 0; index < newSlotCount; index++)
+			pool->slots[index] = EMPTY_SLOT;
+
+		for (index = 0; index < oldSlotCount; index++)
+		{
+			if (oldSlots[index] != EMPTY_SLOT)
+				pool->slots[pool_slot(pool, POOL_STR(pool, oldSlots[index]))] = oldSlots[index];
+		}
+		free(oldSlots);
+	}
+
+	slot = pool_slot(pool, name);
+	if (pool->slots[slot] != EMPTY_SLOT)
+		return pool->slots[slot]; /* the name is already interned */
+
+	/* growing the characters */
+	if (pool->size + len > pool->capacity)
+	{
+		int newCapacity = (pool->capacity == 0) ? STRING_POOL_INIT_SIZE : pool->capacity;
+
+		char *temp;
+
+		while (pool->size + len > newCapacity)
+			newCapacity *= 2;
+
+		if ((temp = (char *)realloc(pool->chars, newCapacity)) == NULL)
+			return FUNC_ERROR;
+
+		pool->chars = temp;
+		pool->capacity = newCapacity;
 	}
-	return FALSE;
+
+	strcpy(pool->chars + pool->size, name);
+	pool->slots[slot] = pool->size;
+	pool->size += len;
+	pool->count++;
+
+	return pool->slots[slot];
+}
+
+/* Empties a string pool, keeping its memory for the names of the next file.
+   Parameters:
+   - pool: The string pool.
+*/
+void clear_string_pool(stringPool *pool)
+{
+	int index;
+
+	for (index = 0; index < pool->slotCount; index++)
+		pool->slots[index] = EMPTY_SLOT;
+
+	pool->size = pool->count = 0;
+}
+
+/* Frees the memory allocated for a string pool, leaving it empty.
+   Parameters:
+   - pool: The string pool.
+*/
+void free_string_pool(stringPool *pool)
+{
+	free(pool->chars);
+	free(pool->slots);
+
+	pool->chars = NULL;
+	pool->slots = NULL;
+	pool->size = pool->capacity = pool->slotCount = pool->count = 0;
+}
+
+/* Makes room in a line buffer for more lines.
+   Parameters:
+   - lines: The line buffer.
+   - lineCount: The number of lines to make room for.
+   - size: The number of characters they take, null terminators included.
+
+   Returns:
+   - 1 (TRUE) if there is enough room.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int reserve_lines(lineBuffer *lines, int lineCount, int size)
+{
+	/* growing the line offsets */
+	if (lines->count + lineCount > lines->lineCapacity)
+	{
+		int newCapacity = (lines->lineCapacity == 0) ? LINE_BUFFER_INIT_LINES : lines->lineCapacity;
+
+		int *temp;
+
+		while (lines->count + lineCount > newCapacity)
+			newCapacity *= 2;
+
+		if ((temp = (int *)realloc(lines->starts, newCapacity * sizeof(int))) == NULL)
+			return FUNC_ERROR;
+
+		lines->starts = temp;
+		lines->lineCapacity = newCapacity;
+	}
+
+	/* growing the characters */
+	if (lines->size + size > lines->capacity)
+	{
+		int newCapacity = (lines->capacity == 0) ? LINE_BUFFER_INIT_SIZE : lines->capacity;
+
+		char *temp;
+
+		while (lines->size + size > newCapacity)
+			newCapacity *= 2;
+
+		if ((temp = (char *)realloc(lines->chars, newCapacity)) == NULL)
+			return FUNC_ERROR;
+
+		lines->chars = temp;
+		lines->capacity = newCapacity;
+	}
+	return TRUE;
+}
+
+/* Appends a line to a line buffer, followed by a newline character.
+   Parameters:
+   - lines: The line buffer.
+   - line: The line, without its newline character.
+
+   Returns:
+   - 1 (TRUE) if the line was added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int add_line(lineBuffer *lines, const lineSlice *line)
+{
+	char *copy;
+
+	if (reserve_lines(lines, 1, line->len + 2) == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	copy = lines->chars + lines->size;
+	memcpy(copy, line->start, line->len);
+	copy[line->len] = '\n';
+	copy[line->len + 1] = '\0';
+
+	lines->starts[lines->count++] = lines->size;
+	lines->size += line->len + 2;
+
+	return TRUE;
+}
+
+/* Appends all of the lines of one line buffer to another, with a single copy of their characters.
+   Parameters:
+   - lines: The line buffer to append to.
+   - toAppend: The line buffer whose lines are appended.
+
+   Returns:
+   - 1 (TRUE) if the lines were added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int append_lines(lineBuffer *lines, const lineBuffer *toAppend)
+{
+	int index;
+
+	if (toAppend->count == 0)
+		return TRUE;
+
+	if (reserve_lines(lines, toAppend->count, toAppend->size) == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	memcpy(lines->chars + lines->size, toAppend->chars, toAppend->size);
+
+	for (index = 0; index < toAppend->count; index++)
+		lines->starts[lines->count++] = lines->size + toAppend->starts[index];
+
+	lines->size += toAppend->size;
+
+	return TRUE;
+}
+
+/* Shrinks the memory of a line buffer that is done growing to the size of its lines.
+   Parameters:
+   - lines: The line buffer.
+
+   Notes:
+   - The buffer is left as it is if the memory could not be reallocated.
+*/
+void fit_line_buffer(lineBuffer *lines)
+{
+	char *tempChars;
+	int *tempStarts;
+
+	if (lines->count == 0)
+		return;
+
+	if ((tempChars = (char *)realloc(lines->chars, lines->size)) != NULL)
+	{
+		lines->chars = tempChars;
+		lines->capacity = lines->size;
+	}
+	if ((tempStarts = (int *)realloc(lines->starts, lines->count * sizeof(int))) != NULL)
+	{
+		lines->starts = tempStarts;
+		lines->lineCapacity = lines->count;
+	}
+}
+
+/* Empties a line buffer, keeping its memory for the lines of the next file.
+   Parameters:
+   - lines: The line buffer.
+*/
+void clear_line_buffer(lineBuffer *lines)
+{
+	lines->size = lines->count = 0;
+}
+
+/* Frees the memory allocated for a line buffer, leaving it empty.
+   Parameters:
+   - lines: The line buffer.
+*/
+void free_line_buffer(lineBuffer *lines)
+{
+	free(lines->chars);
+	free(lines->starts);
+
+	lines->chars = NULL;
+	lines->starts = NULL;
+	lines->size = lines->capacity = lines->count = lines->lineCapacity = 0;
+}
+
+/* Makes sure an output buffer has room for more characters, doubling its capacity as needed.
+   Parameters:
+   - out: The output buffer.
+   - size: The number of characters to make room for.
+
+   Returns:
+   - 1 (TRUE) if there is enough room.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int reserve_output(outputBuffer *out, int size)
+{
+	int newCapacity;
+	char *temp;
+
+	if (out->size + size <= out->capacity)
+		return TRUE;
+
+	newCapacity = (out->capacity == 0) ? OUTPUT_BUFFER_INIT_SIZE : out->capacity;
+	while (out->size + size > newCapacity)
+		newCapacity *= 2;
+
+	if ((temp = (char *)realloc(out->chars, newCapacity)) == NULL)
+		return FUNC_ERROR;
+
+	out->chars = temp;
+	out->capacity = newCapacity;
+	return TRUE;
+}
+
+/* Creates an output file and writes the contents of an output buffer to it, with a single write.
+   Parameters:
+   - stage: The stage of the program, for diagnostics.
+   - name: The name of the file.
+   - out: The output buffer.
+
+   Returns:
+   - 1 (TRUE) if the file was written.
+   - -1 (FUNC_ERROR) if the file could not be opened or written, in which case it is removed.
+*/
+int write_output(const errStage *stage, char *name, outputBuffer *out)
+{
+	int written;
+
+	FILE *file = fopen(name, "w");
+	if (file == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], name);
+		return FUNC_ERROR;
+	}
+
+	/* an empty buffer has no characters allocated */
+	written = (out->size > 0) ? (int)fwrite(out->chars, 1, out->size, file) : 0;
+	count_io(stage, TRUE, 0, written);
+	if (fclose(file) != 0 || written != out->size)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_FWRITE], name);
+		remove(name);
+		return FUNC_ERROR;
+	}
+	return TRUE;
+}
+
+/* Keeps the contents of an output file that was written, for the output cache, leaving the output buffer empty.
+   Parameters:
+   - kept: The kept contents of the output files, in the order of the outputFile flags - or NULL if they are not kept.
+   - flag: The file's outputFile flag.
+   - out: The output buffer the file was written from.
+*/
+void keep_output(outputBuffer kept[], int flag, outputBuffer *out)
+{
+	int index = 0;
+
+	if (kept == NULL)
+		return;
+
+	while ((1 << index) != flag)
+		index++;
+
+	/* the buffer is handed over, rather than copied */
+	free_output_buffer(&kept[index]);
+	kept[index] = *out;
+
+	out->chars = NULL;
+	out->size = out->capacity = 0;
+}
+
+/* Counts a file that was opened (or the standard input), for the -stats report.
+   Parameters:
+   - stage: The stage that opened the file - nothing is counted if its io is NULL.
+   - opened: Whether a file was opened, rather than the standard input read.
+   - bytesRead: The bytes read from it.
+   - bytesWritten: The bytes written to it.
+*/
+void count_io(const errStage *stage, int opened, long bytesRead, long bytesWritten)
+{
+	if (stage->io == NULL)
+		return;
+
+	if (opened)
+		stage->io->filesOpened++;
+	stage->io->bytesRead += bytesRead;
+	stage->io->bytesWritten += bytesWritten;
+}
+
+/* Frees the memory allocated for an output buffer, leaving it empty.
+   Parameters:
+   - out: The output buffer.
+*/
+void free_output_buffer(outputBuffer *out)
+{
+	free(out->chars);
+
+	out->chars = NULL;
+	out->size = out->capacity = 0;
+}
+
+/* Finds the slot of a symbol's name in the symbol table's hash index, or the empty slot where it should be placed.
+   Parameters:
+   - symbols: The symbol table.
+   - name: The id of the symbol's name in the string pool.
+
+   Returns:
+   - The index of the slot.
+*/
+int symbol_slot(symbolTable *symbols, int name)
+{
+	int index = (int)(ID_HASH(name) & (symbols->slotCount - 1));
+
+	while (symbols->slots[index] != EMPTY_SLOT && symbols->entries[symbols->slots[index]].name != name)
+		index = (index + 1) & (symbols->slotCount - 1); /* linear probing */
+
+	return index;
+}
+
+/* Finds the entry of a name in the symbol table, placeholders included.
+   Parameters:
+   - symbols: The symbol table.
+   - name: The name to look for.
+
+   Returns:
+   - 0+: The index of the name's entry.
+   - -1 (EMPTY_SLOT) if the name has no entry.
+*/
+int symbol_index(symbolTable *symbols, const char *name)
+{
+	int id;
+
+	if (symbols == NULL || symbols->count == 0 || (id = find_name(symbols->names, name)) == EMPTY_SLOT)
+		return EMPTY_SLOT;
+
+	return symbols->slots[symbol_slot(symbols, id)];
+}
+
+/* A function that checks if a string is a symbol's name.
+   Parameters:
+   - symbols: The symbol table.
+   - toCheck: The string to check if it's a symbol's name.
+
+   Returns:
+   - Pointer to the symbol's entry if the string is a symbol's name (valid until the next symbol is added).
+   - NULL if the string is not a symbol's name, or is only a placeholder for a label that was not defined yet.
+*/
+symbolEntry *is_symbol(symbolTable *symbols, char *toCheck)
+{
+	int index = symbol_index(symbols, toCheck);
+
+	if (index == EMPTY_SLOT || symbols->entries[index].type == symbolType_pending)
+		return NULL;
+
+	/* there is a symbol with the same name */
+	return &symbols->entries[index];
+}
+
+/* Classifies a mnemonic using the perfect hash generated by gen_tables.
+   Parameters:
+   - name: The mnemonic (does not have to be null terminated).
+   - len: The mnemonic's length.
+
+   Returns:
+   - -1 (FUNC_ERROR): The string is not a mnemonic.
+   - 0-15: Index corresponding to opcodes.
+   - 17-21: Index corresponding to directives.
+
+   Notes:
+   - The hash leads to the only slot the mnemonic could be in, which is then verified by its length and contents.
+*/
+int classify_mnemonic(const char *name, int len)
+{
+	const mnemonicSlot *slot;
+
+	if (len < 1 || len > MAX_DIR_LENGTH)
+		return FUNC_ERROR;
+
+	slot = &mnemonicTable[MNEMONIC_HASH(name, len, MNEMONIC_MUL_FIRST, MNEMONIC_MUL_SECOND, MNEMONIC_MUL_LAST,
+										MNEMONIC_TABLE_SIZE)];
+
+	if (slot->len != len || memcmp(slot->name, name, len) != 0)
+		return FUNC_ERROR;
+
+	return slot->element;
 }
 
 /* A function that processes assembly code lines and determines the element type.
@@ -161,38 +874,31 @@ symbolNode *is_symbol(symbolNode *head, char *toCheck)
    - lineIndex: The line index where the error occurred.
    - ipName: The input file name.
    - toCheck: The string to check for its element type.
-   - resNames: The reserved names file name.
-   - dirList: An array of directives.
-   - ocList: An array of opcodes.
+   - dirList: An array of directives, NULL if directives are not expected.
+   - ocList: An array of opcodes, NULL if opcodes are not expected.
 
    Returns:
    - -1 (FUNC_ERROR): Error - unrecognized element.
    - 0-15: Index corresponding to opcodes.
-   - 18-22: Index corresponding to directives.
+   - 17-21: Index corresponding to directives.
 */
 int find_element_type(ERR_DETAILS_SIG, char *toCheck, Directives dirList[], Opcodes ocList[])
 {
-	int index;
+	int element;
 
 	if (toCheck == NULL)
 		return FUNC_ERROR;
 
-	/* going through the oclist array*/
-	if (ocList != NULL)
-		for (index = 0; index < Element_instructionEnd; index++)
-		{
-			if (strcmp(toCheck, ocList[index].name) == 0)
-				return index;
-		}
-	/* going through the dirlist array */
-	if (dirList != NULL)
-		for (index = 0; index < Element_directiveEnd - 1 - Element_instructionEnd; index++)
-		{
-			if (strcmp(toCheck, dirList[index].name) == 0)
-				return index + Element_instructionEnd + 1;
-		}
-	err_with_line(ERR_DETAILS, generalErrList[GEN_ERR_UNKNOWN_ELEMENT], toCheck);
-	return FUNC_ERROR;
+	element = classify_mnemonic(toCheck, strlen(toCheck));
+
+	/* the element must belong to one of the given lists */
+	if ((element < Element_instructionEnd && ocList == NULL) || (element > Element_instructionEnd && dirList == NULL))
+		element = FUNC_ERROR;
+
+	if (element == FUNC_ERROR)
+		err_with_line(ERR_DETAILS, generalErrList[GEN_ERR_UNKNOWN_ELEMENT], toCheck);
+
+	return element;
 }
 
 /*
@@ -200,33 +906,29 @@ int find_element_type(ERR_DETAILS_SIG, char *toCheck, Directives dirList[], Opco
 
    Parameters:
    - ERR_DETAILS_SIG: Error details signature for error reporting.
-   - operand: The string representing an operand.
-   - head: Pointer to the head of the symbol table.
-   - resNames: The file name for reserved names.
+   - operand: The string representing an operand, as tokenized (without white spaces).
+   - symbols: The symbol table.
+   - resNames: The reserved names index.
 
    Returns:
    - -1 (ERROR) if the addressing method is not recognized.
    - 0-3 according to the addressing method that was detected.
 */
-int find_addressing(ERR_DETAILS_SIG, char *operand, symbolNode *head, char *resNames, int toPrint)
+int find_addressing(ERR_DETAILS_SIG, char *operand, symbolTable *symbols, resNamesIndex *resNames, int toPrint)
 {
 	int index,
 		len = strlen(operand);
 
 	char opCopy[MAX_LINE_LENGTH + 1],
-		*temp;
+		*temp = operand;
 
 	if (operand == NULL)
 		return FUNC_ERROR;
 
-	remove_edge_ws(operand);
-	strcpy(opCopy, operand);
-	temp = opCopy;
-
 	/* 00 - immediate addressing - the operand is an #mdefine || #int*/
 	if (temp[0] == '#')
 	{
-		int value = int_from_abs_arg(++temp, head); /* temp will be read from the char coming after # */
+		int value = int_from_abs_arg(++temp, symbols); /* temp will be read from the char coming after # */
 
 		if (value == INT_FUNC_ERROR)
 		{
@@ -244,7 +946,7 @@ int find_addressing(ERR_DETAILS_SIG, char *operand, symbolNode *head, char *resN
 	}
 	if (temp[0] == '#')
 	{
-		int value = int_from_abs_arg(++temp, head); /* temp will be read from the char coming after # */
+		int value = int_from_abs_arg(++temp, symbols); /* temp will be read from the char coming after # */
 
 		if (!isdigit(*temp))
 		{
@@ -267,7 +969,7 @@ int find_addressing(ERR_DETAILS_SIG, char *operand, symbolNode *head, char *resN
 		return addMethod_immediate;
 	}
 	/* 01 - direct addressing - the operand is a label */
-	if (valid_label(ERR_DETAILS, temp, resNames, FALSE, head) > FALSE)
+	if (valid_label(ERR_DETAILS, temp, resNames, FALSE, symbols) > FALSE)
 		return addMethod_direct;
 
 	/* 10 - constant index addressing - the operand is a label[mdefine || int] */
@@ -279,7 +981,12 @@ int find_addressing(ERR_DETAILS_SIG, char *operand, symbolNode *head, char *resN
 
 		char *checkContents;
 
-		symbolNode *tempNode;
+		symbolEntry *tempNode;
+
+		/* the brackets are split on a copy, the operand itself is left as it is */
+		strcpy(opCopy, operand);
+		temp = opCopy;
+
 		for (index = 0; index < len; index++)
 		{
 			if (temp[index] == '[' && lbC == 0)
@@ -313,12 +1020,12 @@ int find_addressing(ERR_DETAILS_SIG, char *operand, symbolNode *head, char *resN
 		if (rbC == 1 && lbC == 1)
 		{
 			/* now, checkContents holds the argument inside the brackets */
-			tempNode = is_symbol(head, checkContents);
+			tempNode = is_symbol(symbols, checkContents);
 
 			if ((tempNode != NULL && tempNode->type == symbolType_mdefine) || is_string_valid_int(checkContents))
 			{
 				/* check if the string preceeding the brackets makes for a valid label */
-				if (valid_label(ERR_DETAILS, temp, resNames, FALSE, head) > FALSE)
+				if (valid_label(ERR_DETAILS, temp, resNames, FALSE, symbols) > FALSE)
 					return addMethod_constInd;
 			}
 		}
@@ -345,26 +1052,24 @@ int find_addressing(ERR_DETAILS_SIG, char *operand, symbolNode *head, char *resN
  * The string could be either a whole number, or an mdefine.
  *
  * Parameters:
- * - string: The input string to convert to an integer.
- * - head: Pointer to the head of the symbol table.
+ * - string: The input string to convert to an integer, without white spaces.
+ * - symbols: The symbol table.
  *
  * Returns:
  * - The converted integer value if successful.
  * - INT_FUNC_ERROR if the given string is neither an int nor an mdefine.
  */
-int int_from_abs_arg(char *string, symbolNode *head)
+int int_from_abs_arg(char *string, symbolTable *symbols)
 {
 	int value;
 
-	symbolNode *tempNode;
-
-	string = remove_edge_ws(string);
+	symbolEntry *tempNode;
 
 	if (string != NULL && is_string_valid_int(string))
 		value = atoi(string);
 	else
 	{
-		tempNode = is_symbol(head, string);
+		tempNode = is_symbol(symbols, string);
 		if (tempNode != NULL && tempNode->type == symbolType_mdefine)
 			value = tempNode->value;
 		else
@@ -379,7 +1084,7 @@ int int_from_abs_arg(char *string, symbolNode *head)
    Checks if a string represents a valid integer.
 
    Parameters:
-   - toCheck: The string to check for integer validity.
+   - toCheck: The string to check for integer validity, without white spaces.
 
    Returns:
    - 1 (TRUE) if the string is a valid integer.
@@ -388,10 +1093,7 @@ int int_from_abs_arg(char *string, symbolNode *head)
 int is_string_valid_int(char *toCheck)
 {
 	int index,
-		len;
-
-	remove_edge_ws(toCheck);
-	len = strlen(toCheck);
+		len = strlen(toCheck);
 
 	/* only the first character is allowed to be either a minus/plus sign, or a digit */
 	if (toCheck[0] != '-' && toCheck[0] != '+' && !isdigit(toCheck[0]))
@@ -412,27 +1114,24 @@ int is_string_valid_int(char *toCheck)
    - stage: The stage in which the error occurred.
    - lineIndex: The line index where the error occurred.
    - ipName: The input file name.
-   - toCheck: The string to check if it's a valid label name.
-   - resNames: The reserved names file name.
+   - toCheck: The string to check if it's a valid label name, without white spaces.
+   - resNames: The reserved names index.
    - toPrint: Flag to indicate whether error printing is enabled (this function is used in multiple scenarios, not all of them neccecitate error printing).
 
    Returns:
-   - -1 (FUNC_ERROR): Error - could not open the reserved names file.
+   - -1 (FUNC_ERROR): Error - could not access the reserved names index.
    -  0 (FALSE) if the string is not a valid label name.
    -  1 (TRUE) if the string is a valid label name.
    -  2 (LABEL_IS_ENTRY) if the string is the name of an existing entry label
    -  3 (LABEL_EXISTS) if the string is the name of an existing label
 */
-int valid_label(ERR_DETAILS_SIG, char *toCheck, char *resNames, int toPrint, symbolNode *head)
+int valid_label(ERR_DETAILS_SIG, char *toCheck, resNamesIndex *resNames, int toPrint, symbolTable *symbols)
 {
 	int index,
 		len,
 		resNameVal;
 
-	symbolNode *tempNode;
-
-	remove_edge_ws(toCheck);
-	tempNode = is_symbol(head, toCheck);
+	symbolEntry *tempNode = is_symbol(symbols, toCheck);
 
 	if (tempNode != NULL)
 	{
@@ -456,7 +1155,7 @@ int valid_label(ERR_DETAILS_SIG, char *toCheck, char *resNames, int toPrint, sym
 	if (resNameVal == FUNC_ERROR)
 	{
 		if (toPrint)
-			err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], resNames);
+			err_wo_line(stage, generalErrList[GEN_ERR_RES_NAMES], NULL);
 		return FUNC_ERROR;
 	}
 
@@ -498,6 +1197,9 @@ const char *generalErrList[] =
 		"The following label name is already a symbol",
 		"The following label's name is longer than 31 characters",
 		"The following label's name is conflicting with a reserved name",
-		"The following label name is invalid"
+		"The following label name is invalid",
+		"The argument following '#' is not a number",
+		"Could not access the reserved names index",
+		"Could not write the following file"
 
 };
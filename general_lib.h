@@ -20,9 +20,23 @@
 #define OC_INT_BIT_LENGTH 12
 #define DIR_INT_BIT_LENGTH 14
 #define IMAGE_OFFSET 100
+#define IMAGE_WORDS (RAM_SIZE - IMAGE_OFFSET) /* the words of the code and data images, after the load address */
 #define INT_FUNC_ERROR (MAX_DIR_NUM + 1)
 #define LABEL_IS_ENTRY 2
 #define LABEL_EXISTS 3
+#define NAME_SET_INIT_SIZE 64
+#define SYMBOL_TABLE_INIT_SIZE 64
+#define FIXUP_TABLE_INIT_SIZE 64
+#define DATA_IMAGE_INIT_SIZE 64
+#define STRING_POOL_INIT_SIZE 1024
+#define LINE_BUFFER_INIT_SIZE 4096
+#define LINE_BUFFER_INIT_LINES 128
+#define OUTPUT_BUFFER_INIT_SIZE 1024
+#define OUTPUT_KINDS 5 /* the outputFile flags */
+#define DIAG_LIST_INIT_SIZE 16
+#define DIAG_CHARS_INIT_SIZE 256
+#define SYMBOL_REFS_INIT_SIZE 16
+#define EMPTY_SLOT -1
 
 /* return values for stages */
 #define SUCCESS 0
@@ -40,6 +54,32 @@
 #define SRC_OP_MOVE 4
 #define DEST_OP_MOVE 2
 #define OP_VALUE_MOVE 2
+#define SRC_REG_MOVE 5
+#define DEST_REG_MOVE 2
+#define IMM_OP_MOVE 2
+#define LABEL_ADD_MOVE 2
+
+/* masks of the fields of a word */
+#define ARE_MASK 3
+#define ADD_METHOD_MASK 3
+#define OPCODE_MASK 0xF
+#define REG_MASK 7
+
+/* the base 4 encoding - every 2 bits of a word are one symbol, a byte is 4 symbols */
+#define BASE4_SYMBOLS "*#%!"
+#define BYTE_VALUES 256
+#define BYTE_SYMBOLS 4
+#define WORD_SYMBOLS 7
+
+/* the binary object format (.obj) - little endian 16-bit fields:
+   magic, origin, IC, DC, entry count, extern count, the code and data words,
+   then an entry record and an extern record (address, name length byte, name) for every symbol */
+#define OBJ_MAGIC "AOB1"
+#define OBJ_MAGIC_LENGTH 4
+#define OBJ_FIELD_SIZE 2
+#define OBJ_HEADER_FIELDS 5
+#define OBJ_HEADER_LENGTH (OBJ_MAGIC_LENGTH + OBJ_HEADER_FIELDS * OBJ_FIELD_SIZE)
+#define WORD_MASK 0x3FFF /* the 14 bits of a memory word */
 
 /* other */
 #define PLACEHOLDER (MAX_DIR_NUM + 1)
@@ -58,14 +98,35 @@
 #define DELIM " \t\n\r\f"
 #define DELIM_WITH_COMMA " \t\n\r\f,"
 
+/* the text of a line in a line buffer */
+#define LINE_AT(lines, index) ((lines)->chars + (lines)->starts[(index)])
+
+/* the string of an interned name */
+#define POOL_STR(pool, id) ((pool)->chars + (id))
+
+/* a file name or a specifier of a diagnostic, or NULL if it has none */
+#define DIAG_STR(diags, offset) (((offset) == EMPTY_SLOT) ? NULL : (diags)->chars + (offset))
+
+/* whether a diagnostics list has as many diagnostics as it keeps - the stages stop early once it does */
+#define DIAG_LIMIT_REACHED(diags) ((diags) != NULL && (diags)->limit > 0 && (diags)->count >= (diags)->limit)
+
+/* the hash of a mnemonic of the given length - gen_tables finds the multipliers and size that make it perfect */
+#define MNEMONIC_HASH(name, len, mulFirst, mulSecond, mulLast, size)               \
+	(((mulFirst) * (unsigned char)(name)[0] +                                        \
+	  (mulSecond) * ((len) > 1 ? (unsigned char)(name)[1] : 0) +                    \
+	  (mulLast) * (unsigned char)(name)[(len) - 1] + (len)) & ((size) - 1))
+
+/* the hash of an interned name's id (Knuth's multiplicative hashing) */
+#define ID_HASH(id) (((unsigned long)(id) * 2654435761UL) & 0xFFFFFFFFUL)
+
 #define ERR_DETAILS \
 	stage, lineIndex, ipName
 
 #define ERR_DETAILS_SIG \
-	const char *stage, int lineIndex, char *ipName
+	const errStage *stage, int lineIndex, char *ipName
 
 #define ERROR_WO_LINE \
-	fprintf(stderr, "\n>>> Error (during the %s stage): \n", stage);
+	fprintf(stderr, "\n>>> Error (during the %s stage): \n", stage->name);
 
 #define ERROR_WITH_LINE                                            \
 	do                                                             \
@@ -92,7 +153,8 @@ enum symbolType
 	symbolType_entry,
 	symbolType_extern,
 	symbolType_entryTemp,
-	symbolType_entryDir
+	symbolType_entryDir,
+	symbolType_pending /* a placeholder for a label that was used before its definition */
 };
 
 enum ARE
@@ -138,6 +200,16 @@ enum Element /* indices of instructions and directives */
 	Element_directiveEnd
 };
 
+/* The output files of a source, as flags - in the order they are written */
+enum outputFile
+{
+	OUTPUT_AM = 1,	/* the macro-expanded source */
+	OUTPUT_OBJ = 2, /* the binary object file */
+	OUTPUT_OB = 4,	/* the object file */
+	OUTPUT_EXT = 8, /* the extern file */
+	OUTPUT_ENT = 16 /* the entry file */
+};
+
 /* Enum definitions for general errors of any stage */
 enum generalErrIndex
 {
@@ -150,7 +222,10 @@ enum generalErrIndex
 	GEN_ERR_LONG_LABEL_NAME,	/* label name exceeds maximum length */
 	GEN_ERR_LABEL_NAME_RES,		/* detected an attempt to name a label with a reserved name */
 	GEN_ERR_INVALID_LABEL_NAME, /* Invalid label name */
-	GEN_ERR_INVALID_IMM_ARG		/* The argument coming after '#' is not a digit */
+	GEN_ERR_INVALID_IMM_ARG,	/* The argument coming after '#' is not a digit */
+	GEN_ERR_RES_NAMES,			/* The reserved names index is not available */
+	GEN_ERR_FWRITE,				/* Error writing to a file */
+	GEN_ERR_END
 };
 
 /* ___Constants___*/
@@ -167,6 +242,14 @@ typedef struct Opcodes
 		destOpAdd[ADD_METHODS_NUM + 1];
 } Opcodes;
 
+/* a slot of the generated mnemonic table */
+typedef struct mnemonicSlot
+{
+	char name[MAX_DIR_LENGTH + 1];
+	int len,
+		element; /* index of the instruction or directive, FUNC_ERROR for an empty slot */
+} mnemonicSlot;
+
 typedef struct Directives
 {
 	char name[MAX_DIR_LENGTH + 1];
@@ -174,34 +257,195 @@ typedef struct Directives
 		isLabelAllowed;
 } Directives;
 
-typedef struct symbolNode
+/* an open addressing hash set of names, the capacity is always a power of 2 */
+typedef struct nameSet
+{
+	char **slots; /* NULL marks an empty slot */
+	int capacity,
+		count;
+} nameSet;
+
+/* the reserved names - built once per run, with an overlay of the current file's macro names */
+typedef struct resNamesIndex
+{
+	nameSet base, /* registers, opcodes and directives */
+		mcrs;	  /* macro names of the file being processed */
+} resNamesIndex;
+
+/* a per-file string interner - every distinct name is stored once, and is identified by its offset in chars */
+typedef struct stringPool
+{
+	char *chars; /* the names, each followed by a null terminator */
+	int size,
+		capacity;
+	int *slots; /* ids of names, EMPTY_SLOT marks an empty slot */
+	int slotCount,
+		count;
+} stringPool;
+
+/* a view of part of a line, pointing into its characters (not null terminated) */
+typedef struct lineSlice
+{
+	const char *start;
+	int len; /* without the newline character */
+} lineSlice;
+
+/* the macro-expanded source, handed from the pre-processor to the first pass */
+typedef struct lineBuffer
 {
-	char symbolName[MAX_LABEL_LENGTH + 1];
-	int type,
-		value,
+	char *chars; /* the lines, each ending with a newline and followed by a null terminator */
+	int size,
+		capacity;
+	int *starts; /* the offset of every line in chars */
+	int count,
+		lineCapacity;
+} lineBuffer;
+
+typedef struct symbolEntry
+{
+	int name; /* id in the string pool */
+	short int value;
+	unsigned char type, /* symbolType */
 		ARE;
-	struct symbolNode *next;
-} symbolNode;
+} symbolEntry;
+
+/* the symbol table - the entries are indexed by an open addressing hash table, whose capacity is always a power of 2 */
+typedef struct symbolTable
+{
+	symbolEntry *entries; /* in order of first appearance, placeholders included */
+	int count,
+		capacity;
+	int *defOrder; /* indices of entries, in definition order */
+	int defCount;
+	int *slots; /* indices of entries, keyed by name id, EMPTY_SLOT marks an empty slot */
+	int slotCount;
+	stringPool *names; /* the names of the symbols */
+} symbolTable;
+
+/* a code image word that needs a label's address, to be patched in the second pass */
+typedef struct fixup
+{
+	int symbol,		/* index of the label's entry in the symbol table */
+		IC,			/* the code image cell */
+		readInLine; /* for diagnostics */
+} fixup;
+
+typedef struct fixupTable
+{
+	fixup *items;
+	int count,
+		capacity;
+} fixupTable;
+
+/* the data image - its capacity is doubled when full */
+typedef struct dataBuffer
+{
+	short int *words;
+	int count, /* the DC */
+		capacity;
+} dataBuffer;
+
+/* a label's address - an entry, or an extern reference */
+typedef struct symbolRef
+{
+	const char *name; /* in the string pool of the symbols */
+	int address;
+} symbolRef;
+
+typedef struct symbolRefList
+{
+	symbolRef *items;
+	int count,
+		capacity;
+} symbolRefList;
+
+/* the contents of an output file, staged in memory until the file is written at once */
+typedef struct outputBuffer
+{
+	char *chars; /* not null terminated */
+	int size,
+		capacity;
+} outputBuffer;
+
+/* the files that were opened, and the bytes read from them and written to them */
+typedef struct ioCounts
+{
+	long bytesRead,
+		bytesWritten;
+	int filesOpened;
+} ioCounts;
+
+/* a diagnostic, kept in memory instead of being printed */
+typedef struct diagnostic
+{
+	const char *stage,
+		*error;	   /* the error's text, from its stage's error list */
+	int line,	   /* 0 if it is not about a specific line */
+		file,	   /* the offset of the file's name in the list's chars, EMPTY_SLOT if it is not about a specific line */
+		specifier; /* the offset of the specifier in the list's chars, or EMPTY_SLOT */
+} diagnostic;
+
+/* the diagnostics of a source, in the order they were reported */
+typedef struct diagList
+{
+	diagnostic *items;
+	int count,
+		capacity;
+	char *chars; /* the file names and the specifiers, each followed by a null terminator */
+	int size,
+		charsCapacity;
+	int limit,	 /* the number of diagnostics that are kept, 0 for no limit */
+		dropped; /* diagnostics that could not be kept, for lack of memory or over the limit */
+} diagList;
 
-typedef struct needLabelNode
+/* the stage errors are reported from, and where they go - they are printed to stderr if diags is NULL */
+typedef struct errStage
 {
-	char labelName[MAX_LABEL_LENGTH + 1];
-	int IC,
-		readInLine;
-	struct needLabelNode *next;
-} needLabelNode;
+	const char *name;
+	diagList *diags;
+	ioCounts *io; /* where the files the stage opens are counted, or NULL if they are not */
+} errStage;
 
 /* ___Prototypes___*/
-void err_with_line(const char *stage, int lineIndex, char *ipName, const char *text, char *specifier);
-void err_wo_line(const char *stage, const char *text, char *specifier);
+int add_diag_str(diagList *diags, const char *string);
+void add_diagnostic(diagList *diags, const char *stage, int line, char *ipName, const char *text, char *specifier);
+void clear_diag_list(diagList *diags);
+void free_diag_list(diagList *diags);
+void err_with_line(const errStage *stage, int lineIndex, char *ipName, const char *text, char *specifier);
+void err_wo_line(const errStage *stage, const char *text, char *specifier);
 char *add_ext(char *baseName, char *ext);
 char *remove_edge_ws(char *string);
-int is_reserved_name(char *toCheck, char *resNames);
-symbolNode *is_symbol(symbolNode *head, char *toCheck);
+unsigned long hash_name(const char *name);
+int name_set_slot(char **slots, int capacity, const char *name);
+int name_set_add(nameSet *set, const char *name);
+int name_set_has(nameSet *set, const char *name);
+void name_set_clear(nameSet *set);
+void name_set_free(nameSet *set);
+int is_reserved_name(char *toCheck, resNamesIndex *resNames);
+int pool_slot(stringPool *pool, const char *name);
+int find_name(stringPool *pool, const char *name);
+int intern_name(stringPool *pool, const char *name);
+void clear_string_pool(stringPool *pool);
+void free_string_pool(stringPool *pool);
+int reserve_lines(lineBuffer *lines, int lineCount, int size);
+int add_line(lineBuffer *lines, const lineSlice *line);
+int append_lines(lineBuffer *lines, const lineBuffer *toAppend);
+void fit_line_buffer(lineBuffer *lines);
+void clear_line_buffer(lineBuffer *lines);
+void free_line_buffer(lineBuffer *lines);
+int reserve_output(outputBuffer *out, int size);
+int write_output(const errStage *stage, char *name, outputBuffer *out);
+void keep_output(outputBuffer kept[], int flag, outputBuffer *out);
+void count_io(const errStage *stage, int opened, long bytesRead, long bytesWritten);
+void free_output_buffer(outputBuffer *out);
+int symbol_slot(symbolTable *symbols, int name);
+int symbol_index(symbolTable *symbols, const char *name);
+symbolEntry *is_symbol(symbolTable *symbols, char *toCheck);
+int classify_mnemonic(const char *name, int len);
 int find_element_type(ERR_DETAILS_SIG, char *toCheck, Directives dirList[], Opcodes ocList[]);
-int find_addressing(ERR_DETAILS_SIG, char *operand, symbolNode *head, char *resNames, int toPrint);
-int int_from_abs_arg(char *string, symbolNode *head);
+int find_addressing(ERR_DETAILS_SIG, char *operand, symbolTable *symbols, resNamesIndex *resNames, int toPrint);
+int int_from_abs_arg(char *string, symbolTable *symbols);
 int is_string_valid_int(char *toCheck);
-int valid_label(ERR_DETAILS_SIG, char *toCheck, char *resNames, int toPrint, symbolNode *head);
+int valid_label(ERR_DETAILS_SIG, char *toCheck, resNamesIndex *resNames, int toPrint, symbolTable *symbols);
 
 #endif
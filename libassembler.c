@@ -0,0 +1,472 @@
+#include "libassembler.h"
+#include "pre_process.h"
+#include "first_pass.h"
+#include "second_pass.h"
+
+/* ___The assembler library___ */
+/* Sources are assembled from memory into memory - no files are read or written, and nothing is printed.
+   All of the state is kept in the session and in the units, so a process can assemble any number of units,
+   one at a time for every session. */
+
+/* the error lists of the stages, whose errors have codes */
+const diagCodeList diagCodeLists[DIAG_CODE_LISTS] =
+{
+	{"GEN", generalErrList, GEN_ERR_END},
+	{"PP", ppErrList, PP_ERR_END},
+	{"FP", fpErrList, FP_ERR_END},
+	{"SP", spErrList, SP_ERR_END}
+};
+
+/* Prepares a session - the opcode and directive lists, and the reserved names index.
+   Parameters:
+   - session: The session to prepare.
+
+   Returns:
+   - 0 (SUCCESS) if the session is ready.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int asm_session_init(asmSession *session)
+{
+	resNamesIndex emptyIndex = {{NULL, 0, 0}, {NULL, 0, 0}};
+
+	/* ocList, dirList - definitions of the opcodes and directives, kept in the session */
+	OC_LIST_DEC
+	DIR_LIST_DEC
+
+	memcpy(session->ocList, ocList, sizeof(session->ocList));
+	memcpy(session->dirList, dirList, sizeof(session->dirList));
+	session->resNames = emptyIndex;
+	session->maxErrors = 0;
+
+	if (build_res_names(&session->resNames, session->ocList, session->dirList) == FUNC_ERROR)
+	{
+		free_res_names(&session->resNames);
+		return FUNC_ERROR;
+	}
+	return SUCCESS;
+}
+
+/* Frees the memory allocated for a session.
+   Parameters:
+   - session: The session.
+*/
+void asm_session_free(asmSession *session)
+{
+	free_res_names(&session->resNames);
+}
+
+/* Assembles a source that is in memory.
+   Parameters:
+   - session: The session, whose macro names are reset for the source.
+   - name: The source's name.
+   - source: The source's characters (not null terminated).
+   - size: The number of characters.
+   - unit: The unit to fill.
+
+   Returns:
+   - 0 (SUCCESS) if the source was assembled with no errors - the unit holds its images and symbols.
+   - -1 (QUIT_UPON_ERROR) otherwise - the unit holds the diagnostics.
+
+   Notes:
+   - The unit is freed with free_asm_unit in either case.
+*/
+int assemble_source(asmSession *session, char *name, const char *source, long size, asmUnit *unit)
+{
+	/* ___Declarations___ */
+	/* the array that will represent the code image */
+	short int codeImage[RAM_SIZE] = {PLACEHOLDER};
+
+	/* symbols will be stored in a hashed symbol table */
+	symbolTable symbols = {NULL, 0, 0, NULL, 0, NULL, 0, NULL};
+
+	/* a table that stores the codeImage cells that need labels for the second pass */
+	fixupTable fixups = {NULL, 0, 0};
+
+	/* the macro-expanded source */
+	lineBuffer amLines = {NULL, 0, 0, NULL, 0, 0};
+
+	/* the source, read in place */
+	sourceFile ip;
+
+	asmUnit emptyUnit = {NULL, 0, {NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0, NULL, 0, 0}, {NULL, 0, 0, NULL, 0, 0, 0, 0}};
+
+	int ppRes,
+		fpRes,
+		spRes;
+
+	errStage libStage;
+	const errStage *stage = &libStage;
+
+	*unit = emptyUnit;
+	libStage.name = "assembler";
+	libStage.diags = &unit->diags;
+	libStage.io = NULL;
+	unit->diags.limit = session->maxErrors;
+	symbols.names = &unit->names;
+
+	ip.chars = (char *)source;
+	ip.size = size;
+	ip.pos = 0;
+	ip.mapped = FALSE;
+
+	/* the macro names of the previous unit are no longer reserved */
+	name_set_clear(&session->resNames.mcrs);
+
+	ppRes = expand_macros(&unit->diags, name, &ip, &session->resNames, &unit->names, &amLines);
+	if (ppRes == QUIT_UPON_ERROR)
+	{
+		LIB_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	fpRes = first_pass(&unit->diags, name, &amLines, &session->resNames, codeImage, &unit->data,
+					   session->ocList, session->dirList, &symbols, &fixups);
+	spRes = resolve_labels(&unit->diags, name, codeImage, &symbols, &fixups, &unit->externs);
+
+	if (ppRes < 0 || fpRes < 0 || spRes != SUCCESS)
+	{
+		LIB_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Handing the images and the entries over to the unit___ */
+	if (collect_entries(&symbols, &unit->entries) == FUNC_ERROR ||
+		(unit->code = (short int *)malloc((fpRes + 1) * sizeof(short int))) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		LIB_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+	memcpy(unit->code, codeImage + IMAGE_OFFSET, fpRes * sizeof(short int));
+	unit->IC = fpRes;
+
+	LIB_CLOSE
+	return SUCCESS;
+}
+
+/* Frees the memory allocated for an assembled unit, leaving it empty.
+   Parameters:
+   - unit: The unit.
+*/
+void free_asm_unit(asmUnit *unit)
+{
+	free(unit->code);
+	unit->code = NULL;
+	unit->IC = 0;
+
+	free_data_buffer(&unit->data);
+	free_symbol_refs(&unit->entries);
+	free_symbol_refs(&unit->externs);
+	free_string_pool(&unit->names);
+	free_diag_list(&unit->diags);
+}
+
+/* Finds the code of a diagnostic's error.
+   Parameters:
+   - diag: The diagnostic.
+   - code: Where the code is put (at most DIAG_CODE_LENGTH characters, null terminated).
+
+   Returns:
+   - 1 (TRUE) if the error has a code.
+   - 0 (FALSE) if it is not in any of diagCodeLists.
+*/
+int diag_code(const diagnostic *diag, char code[])
+{
+	int list,
+		index;
+
+	for (list = 0; list < DIAG_CODE_LISTS; list++)
+	{
+		for (index = 0; index < diagCodeLists[list].count; index++)
+		{
+			if (diagCodeLists[list].errors[index] == diag->error)
+			{
+				sprintf(code, "%s%02d", diagCodeLists[list].prefix, index);
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
+/* Writes the diagnostics of a source at once - as the assembler prints its errors, or as JSON lines.
+   Parameters:
+   - out: The stream to write to.
+   - diags: The diagnostics.
+   - source: The source's name, for the JSON lines.
+   - json: Whether to write a JSON object per line, instead of the text.
+
+   Returns:
+   - 1 (TRUE) if all of the diagnostics were written.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation - the diagnostics before it are written.
+
+   Notes:
+   - A JSON line has the fields "source", "file", "line", "stage", "code", "message" and "specifier", those that do not apply being null.
+	 If the diagnostics reached their limit, or some could not be kept, a last line has the fields "source", "limit" and "dropped".
+*/
+int write_diagnostics(FILE *out, diagList *diags, const char *source, int json)
+{
+	outputBuffer text = {NULL, 0, 0};
+
+	int index,
+		res = TRUE;
+
+	char limit[DIAG_NUMBER_LENGTH],
+		dropped[DIAG_NUMBER_LENGTH];
+
+	for (index = 0; index < diags->count && res == TRUE; index++)
+		res = json ? put_diag_json(&text, diags, &diags->items[index], source) : put_diag_text(&text, diags, &diags->items[index]);
+
+	/* ___The diagnostics that were not kept___ */
+	sprintf(limit, "%d", diags->limit);
+	sprintf(dropped, "%d", diags->dropped);
+
+	if (res == TRUE && json && (diags->dropped > 0 || DIAG_LIMIT_REACHED(diags)))
+	{
+		if (put_json_field(&text, "source", source, TRUE, TRUE) == FUNC_ERROR ||
+			put_json_field(&text, "limit", (diags->limit > 0) ? limit : NULL, FALSE, FALSE) == FUNC_ERROR ||
+			put_json_field(&text, "dropped", dropped, FALSE, FALSE) == FUNC_ERROR ||
+			reserve_output(&text, DIAG_NOTE_LENGTH) == FUNC_ERROR)
+			res = FUNC_ERROR;
+		else
+			text.size += sprintf(text.chars + text.size, "}\n");
+	}
+	else if (res == TRUE && !json && (diags->dropped > 0 || DIAG_LIMIT_REACHED(diags)))
+	{
+		if (reserve_output(&text, DIAG_NOTE_LENGTH) == FUNC_ERROR)
+			res = FUNC_ERROR;
+		else if (DIAG_LIMIT_REACHED(diags))
+			text.size += sprintf(text.chars + text.size, "\n>>> The errors reached their limit (%s), the rest of the file was not checked.\n", limit);
+		else
+			text.size += sprintf(text.chars + text.size, "\n>>> %s more errors could not be kept.\n", dropped);
+	}
+
+	if (text.size > 0)
+		fwrite(text.chars, 1, text.size, out);
+	fflush(out);
+
+	free_output_buffer(&text);
+	return res;
+}
+
+/* ___Helper functions___ */
+
+/* Adds a diagnostic to an output buffer, as the assembler prints its errors.
+   Parameters:
+   - out: The output buffer.
+   - diags: The list the diagnostic is in.
+   - diag: The diagnostic.
+
+   Returns:
+   - 1 (TRUE) if the diagnostic was added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int put_diag_text(outputBuffer *out, diagList *diags, const diagnostic *diag)
+{
+	const char *file = DIAG_STR(diags, diag->file),
+			   *specifier = DIAG_STR(diags, diag->specifier);
+
+	int len = strlen(diag->stage) + strlen(diag->error) + DIAG_NOTE_LENGTH +
+			  ((file != NULL) ? strlen(file) : 0) + ((specifier != NULL) ? strlen(specifier) : 0);
+
+	if (reserve_output(out, len) == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	out->size += sprintf(out->chars + out->size, "\n>>> Error (during the %s stage): \n", diag->stage);
+	if (file != NULL)
+		out->size += sprintf(out->chars + out->size, "\"%s\", line #%d:\t", file, diag->line);
+
+	if (specifier != NULL)
+		out->size += sprintf(out->chars + out->size, "%s: \"%s\".\n", diag->error, specifier);
+	else
+		out->size += sprintf(out->chars + out->size, "%s.\n", diag->error);
+	return TRUE;
+}
+
+/* Adds a diagnostic to an output buffer, as a line with a JSON object.
+   Parameters:
+   - out: The output buffer.
+   - diags: The list the diagnostic is in.
+   - diag: The diagnostic.
+   - source: The source's name.
+
+   Returns:
+   - 1 (TRUE) if the diagnostic was added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int put_diag_json(outputBuffer *out, diagList *diags, const diagnostic *diag, const char *source)
+{
+	const char *names[DIAG_JSON_FIELDS] = {"source", "file", "line", "stage", "code", "message", "specifier"},
+			   *values[DIAG_JSON_FIELDS];
+
+	char line[DIAG_NUMBER_LENGTH],
+		code[DIAG_CODE_LENGTH + 1];
+
+	int index;
+
+	sprintf(line, "%d", diag->line);
+
+	values[0] = source;
+	values[1] = DIAG_STR(diags, diag->file);
+	values[2] = (diag->file != EMPTY_SLOT) ? line : NULL;
+	values[3] = diag->stage;
+	values[4] = diag_code(diag, code) ? code : NULL;
+	values[5] = diag->error;
+	values[6] = DIAG_STR(diags, diag->specifier);
+
+	for (index = 0; index < DIAG_JSON_FIELDS; index++)
+	{
+		/* the line (the third field) is the only number */
+		if (put_json_field(out, names[index], values[index], index != 2, index == 0) == FUNC_ERROR)
+			return FUNC_ERROR;
+	}
+
+	if (reserve_output(out, DIAG_NOTE_LENGTH) == FUNC_ERROR)
+		return FUNC_ERROR;
+	out->size += sprintf(out->chars + out->size, "}\n");
+	return TRUE;
+}
+
+/* Adds a field of a JSON object to an output buffer.
+   Parameters:
+   - out: The output buffer.
+   - name: The field's name.
+   - value: The field's value, or NULL for null.
+   - quoted: Whether the value is a string, which is quoted and escaped - a number is added as it is.
+   - first: Whether it is the object's first field, which opens it.
+
+   Returns:
+   - 1 (TRUE) if the field was added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int put_json_field(outputBuffer *out, const char *name, const char *value, int quoted, int first)
+{
+	const unsigned char *current;
+
+	/* an escaped character takes at most 6 characters */
+	if (reserve_output(out, strlen(name) + DIAG_NOTE_LENGTH + ((value != NULL) ? 6 * strlen(value) : 0)) == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	out->size += sprintf(out->chars + out->size, "%s\"%s\":", first ? "{" : ",", name);
+
+	if (value == NULL || !quoted)
+	{
+		out->size += sprintf(out->chars + out->size, "%s", (value != NULL) ? value : "null");
+		return TRUE;
+	}
+
+	out->chars[out->size++] = '"';
+	for (current = (const unsigned char *)value; *current != '\0'; current++)
+	{
+		if (*current == '"' || *current == '\\')
+		{
+			out->chars[out->size++] = '\\';
+			out->chars[out->size++] = (char)*current;
+		}
+		else if (*current < 0x20 || *current == 0x7F)
+			out->size += sprintf(out->chars + out->size, "\\u%04x", *current);
+		else
+			out->chars[out->size++] = (char)*current;
+	}
+	out->chars[out->size++] = '"';
+	return TRUE;
+}
+
+/* A function that builds the reserved names index based on the registers, and the opcode and directive lists.
+   The index is built once per run, the macro names of each file are added to its overlay by the pre-processor.
+   Parameters:
+   - resNames: The reserved names index to fill.
+   - ocList: Array of opcode structures.
+   - dirList: Array of directive structures.
+
+   Returns:
+   - 0 (SUCCESS) if the index was successfully built.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int build_res_names(resNamesIndex *resNames, Opcodes ocList[], Directives dirList[])
+{
+	int index,
+		res = TRUE;
+
+	char regName[REG_NAME_LENGTH + 1];
+
+	for (index = FIRST_REG_NUM; index <= LAST_REG_NUM && res == TRUE; index++)
+	{
+		sprintf(regName, "r%d", index);
+		res = name_set_add(&resNames->base, regName);
+	}
+	for (index = 0; index < Element_instructionEnd && res == TRUE; index++)
+	{
+		res = name_set_add(&resNames->base, ocList[index].name);
+	}
+	for (index = 0; index < (Element_directiveEnd - 1 - Element_instructionEnd) && res == TRUE; index++)
+	{
+		res = name_set_add(&resNames->base, dirList[index].name);
+	}
+
+	return (res == FUNC_ERROR) ? FUNC_ERROR : SUCCESS;
+}
+
+/* Frees the memory allocated for the reserved names index.
+   Parameters:
+   - resNames: The reserved names index.
+*/
+void free_res_names(resNamesIndex *resNames)
+{
+	name_set_free(&resNames->base);
+	name_set_free(&resNames->mcrs);
+}
+
+/* Frees memory allocated for the fixup table, leaving it empty.
+Parameters:
+- fixups: Pointer to the fixup table.
+*/
+void free_fixup_table(fixupTable *fixups)
+{
+	free(fixups->items);
+
+	fixups->items = NULL;
+	fixups->count = fixups->capacity = 0;
+}
+
+/* Frees memory allocated for the data image, leaving it empty.
+Parameters:
+- data: Pointer to the data image.
+*/
+void free_data_buffer(dataBuffer *data)
+{
+	free(data->words);
+
+	data->words = NULL;
+	data->count = data->capacity = 0;
+}
+
+/* Empties the symbol table, keeping its memory for the symbols of the next file.
+Parameters:
+- symbols: Pointer to the symbol table.
+*/
+void clear_symbol_table(symbolTable *symbols)
+{
+	int index;
+
+	for (index = 0; index < symbols->slotCount; index++)
+		symbols->slots[index] = EMPTY_SLOT;
+
+	symbols->count = symbols->defCount = 0;
+}
+
+/* Frees memory allocated for the symbol table, leaving it empty.
+Parameters:
+- symbols: Pointer to the symbol table.
+*/
+void free_symbol_table(symbolTable *symbols)
+{
+	free(symbols->entries);
+	free(symbols->defOrder);
+	free(symbols->slots);
+
+	symbols->entries = NULL;
+	symbols->defOrder = NULL;
+	symbols->slots = NULL;
+	symbols->count = symbols->capacity = symbols->defCount = symbols->slotCount = 0;
+}
@@ -0,0 +1,113 @@
+/* ___The assembler library's interface___ */
+#ifndef LIBASSEMBLER_H
+#define LIBASSEMBLER_H
+
+/* ___Include___ */
+#include "general_lib.h"
+#include "source_reader.h"
+
+/* ___Definitions___ */
+#define DIR_LIST_LENGTH (Element_directiveEnd - 1 - Element_instructionEnd)
+#define DIAG_CODE_LISTS 4
+#define DIAG_CODE_LENGTH 8
+#define DIAG_NUMBER_LENGTH 16
+#define DIAG_NOTE_LENGTH 128 /* room for the fixed text around a diagnostic, or for a note after the diagnostics */
+#define DIAG_JSON_FIELDS 7
+
+/* ___Macros___ */
+#define LIB_CLOSE                        \
+	do                                   \
+	{                                    \
+		free_symbol_table(&symbols);     \
+		free_fixup_table(&fixups);       \
+		free_line_buffer(&amLines);      \
+	} while (0);
+
+/* ___Macro definitions for lists___ */
+#define OC_LIST_DEC 									\
+/* name, index, label, op, source addressing, destination adressing */ \
+	Opcodes ocList[] = {								\
+		{"mov", Element_mov, TRUE, 2, "1111", "0111"},	\
+		{"cmp", Element_cmp, TRUE, 2, "1111", "1111"},	\
+		{"add", Element_add, TRUE, 2, "1111", "0111"},	\
+		{"sub", Element_sub, TRUE, 2, "1111", "0111"},	\
+		{"not", Element_not, TRUE, 1, "0000", "0111"},	\
+		{"clr", Element_clr, TRUE, 1, "0000", "0111"},	\
+		{"lea", Element_lea, TRUE, 2, "0110", "0111"},	\
+		{"inc", Element_inc, TRUE, 1, "0000", "0111"},	\
+		{"dec", Element_dec, TRUE, 1, "0000", "0111"},	\
+		{"jmp", Element_jmp, TRUE, 1, "0000", "0101"},	\
+		{"bne", Element_bne, TRUE, 1, "0000", "0101"},	\
+		{"red", Element_red, TRUE, 1, "0000", "0111"},	\
+		{"prn", Element_prn, TRUE, 1, "0000", "1111"},	\
+		{"jsr", Element_jsr, TRUE, 1, "0000", "0101"},	\
+		{"rts", Element_rts, TRUE, 0, "0000", "0000"},	\
+		{"hlt", Element_hlt, TRUE, 0, "0000", "0000"}};
+
+#define DIR_LIST_DEC 									\
+	/* name, index, label */							\
+	Directives dirList[] = {							\
+		{".data", Element_data, TRUE},					\
+		{".string", Element_string, TRUE},				\
+		{".entry", Element_entry, FALSE},				\
+		{".extern", Element_extern, FALSE},				\
+		{".define", Element_define, FALSE}};
+
+/* ___Typedef___ */
+/* what every source is assembled with - the reserved names are built once, and reused by every unit */
+typedef struct asmSession
+{
+	resNamesIndex resNames;
+	Opcodes ocList[Element_instructionEnd];
+	Directives dirList[DIR_LIST_LENGTH];
+	int maxErrors; /* the number of diagnostics kept for a unit - its assembling stops once it has that many, 0 for no limit */
+} asmSession;
+
+/* an assembled source - its images, its symbols and its diagnostics, all in memory */
+typedef struct asmUnit
+{
+	short int *code; /* the code image, starting at IMAGE_OFFSET */
+	int IC;
+	dataBuffer data; /* the data image, placed after the code image */
+	symbolRefList entries,
+		externs;	 /* every code image cell that refers to an extern label */
+	stringPool names; /* the labels' names, which the entries and the extern references point into */
+	diagList diags;
+} asmUnit;
+
+/* an error list, and the prefix of its errors' codes - an error's code is the prefix, followed by its index in the list */
+typedef struct diagCodeList
+{
+	const char *prefix;
+	const char **errors;
+	int count;
+} diagCodeList;
+
+/* ___Constants___ */
+extern const diagCodeList diagCodeLists[];
+
+/* ___Prototypes___*/
+int asm_session_init(asmSession *session);
+void asm_session_free(asmSession *session);
+int assemble_source(asmSession *session, char *name, const char *source, long size, asmUnit *unit);
+void free_asm_unit(asmUnit *unit);
+int diag_code(const diagnostic *diag, char code[]);
+int write_diagnostics(FILE *out, diagList *diags, const char *source, int json);
+int put_diag_text(outputBuffer *out, diagList *diags, const diagnostic *diag);
+int put_diag_json(outputBuffer *out, diagList *diags, const diagnostic *diag, const char *source);
+int put_json_field(outputBuffer *out, const char *name, const char *value, int quoted, int first);
+int build_res_names(resNamesIndex *resNames, Opcodes ocList[], Directives dirList[]);
+void free_res_names(resNamesIndex *resNames);
+int pre_process(diagList *diags, char *baseName, sourceFile *ip, resNamesIndex *resNames, stringPool *names, lineBuffer *amLines, int writeAm, int *outputs, outputBuffer kept[], ioCounts *io);
+int load_source(diagList *diags, char *baseName, int fromStdin, sourceFile *ip, ioCounts *io);
+int first_pass(diagList *diags, char *baseName, lineBuffer *amLines, resNamesIndex *resNames, short int codeImage[], dataBuffer *data,
+			   Opcodes ocList[], Directives dirList[], symbolTable *symbols, fixupTable *fixups);
+int second_pass(diagList *diags, char *baseName, resNamesIndex *resNames, short int codeImage[], dataBuffer *data,
+				Opcodes ocList[], Directives dirList[], symbolTable *symbols, fixupTable *fixups, int makeOutput, int binaryOb, int IC, int *outputs, outputBuffer kept[], ioCounts *io);
+void remove_outputs(const errStage *stage, char *baseName);
+void free_fixup_table(fixupTable *fixups);
+void free_data_buffer(dataBuffer *data);
+void clear_symbol_table(symbolTable *symbols);
+void free_symbol_table(symbolTable *symbols);
+
+#endif
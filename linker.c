@@ -0,0 +1,621 @@
+#include "linker.h"
+
+/* ___The linker___ */
+/* Combines assembled files into a single image:
+   - The code sections of the files are placed one after the other from IMAGE_OFFSET, followed by their data sections.
+   - Every word marked as relocatable (R) is moved along with the section its address points into.
+   - The entries of all of the files are gathered in a hashed global entry table, through which the
+     words marked as external (E) are patched, according to the .ext files.
+   - A word marked as external that is left unpatched (as when a .ext file is missing) is an error.
+
+   Usage: linker [-o <output>] <files>
+   The files are given without an extension, and their .ob (and .ent, .ext if they exist) files are read.
+   The linked image is written as <output>.ob, along with <output>.ent if any of the files had entries.
+
+   Returns:
+   - 0 (SUCCESS): The files were linked with no errors.
+   - -1 (QUIT_UPON_ERROR): An error was found, and no output files were made.
+*/
+int main(int argc, char *argv[])
+{
+	/* ___Declarations___ */
+	/* the linked code image, addressed like the assembler's */
+	short int codeImage[RAM_SIZE];
+
+	/* the linked data image */
+	dataBuffer data = {NULL, 0, 0};
+
+	linkUnit *units = NULL;
+
+	/* the names of the entries, each interned once */
+	stringPool names = {NULL, 0, 0, NULL, 0, 0};
+
+	entryTable entries = {NULL, 0, 0, NULL, 0, NULL};
+
+	/* the output files are staged in memory, and only written if there were no errors */
+	outputBuffer obOut = {NULL, 0, 0},
+				 entOut = {NULL, 0, 0};
+
+	char *outName = DEFAULT_OUTPUT,
+		 *obName = NULL,
+		 *entName = NULL;
+
+	int index,
+		firstFile,
+		unitCount = 0,
+		IC = 0,
+		foundErrorFlag = FALSE;
+
+	/* errors are printed to stderr */
+	const errStage linkStage = {"linker", NULL},
+				   *stage = &linkStage;
+
+	/* ___Starting to process the command line input___ */
+	if ((firstFile = parse_link_options(stage, argc, argv, &outName)) == FUNC_ERROR)
+		return QUIT_UPON_ERROR;
+
+	if (argc - firstFile < LINK_MIN_FILES)
+	{
+		err_wo_line(stage, linkErrList[LINK_ERR_MISSING_ARGS], NULL);
+		return QUIT_UPON_ERROR;
+	}
+
+	entries.names = &names;
+
+	if ((units = (linkUnit *)calloc(argc - firstFile, sizeof(linkUnit))) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Reading the object files, and placing their sections___ */
+	for (index = firstFile; index < argc; index++)
+	{
+		units[unitCount].image.baseName = argv[index];
+		if (read_ob(stage, &units[unitCount++].image) != TRUE)
+			foundErrorFlag = TRUE;
+	}
+
+	if (foundErrorFlag || layout_units(stage, units, unitCount) != TRUE)
+	{
+		LINK_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Relocating, and gathering the entries of all of the files___ */
+	for (index = 0; index < unitCount; index++)
+	{
+		if (relocate_unit(stage, &units[index]) != TRUE)
+			foundErrorFlag = TRUE;
+	}
+	for (index = 0; index < unitCount; index++)
+	{
+		if (read_ent(stage, units, index, &entries) != TRUE)
+			foundErrorFlag = TRUE;
+	}
+
+	/* ___Patching the extern references, only once all of the entries are known___ */
+	/* the words left unpatched are only looked for in a file whose references were all patched, so none is reported twice */
+	for (index = 0; index < unitCount; index++)
+	{
+		if (resolve_ext(stage, units, index, &entries) != TRUE || find_unpatched(stage, &units[index]) != TRUE)
+			foundErrorFlag = TRUE;
+	}
+
+	if (foundErrorFlag)
+	{
+		LINK_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Putting the linked image together___ */
+	for (index = 0; index < unitCount; index++)
+		IC += units[index].image.IC;
+
+	data.count = data.capacity = units[unitCount - 1].dataBase + units[unitCount - 1].image.DC - IMAGE_OFFSET - IC;
+	if ((data.words = (short int *)malloc((data.count + 1) * sizeof(short int))) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		LINK_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	for (index = 0; index < unitCount; index++)
+	{
+		linkUnit *current = &units[index];
+
+		if (current->image.IC > 0)
+			memcpy(codeImage + current->codeBase, current->image.words, current->image.IC * sizeof(short int));
+		if (current->image.DC > 0)
+			memcpy(data.words + current->dataBase - IMAGE_OFFSET - IC, current->image.words + current->image.IC, current->image.DC * sizeof(short int));
+	}
+
+	/* ___Staging and writing the output files___ */
+	if (write_ob(codeImage, IC, &data, &obOut) == FUNC_ERROR)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		LINK_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+	for (index = 0; index < entries.count; index++)
+	{
+		if (add_symbol_record(&entOut, POOL_STR(&names, entries.entries[index].name), entries.entries[index].address, FALSE) == FUNC_ERROR)
+		{
+			err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+			LINK_CLOSE
+			return QUIT_UPON_ERROR;
+		}
+	}
+
+	if ((obName = add_ext(outName, ".ob")) == NULL || (entName = add_ext(outName, ".ent")) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		LINK_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	if (write_output(stage, obName, &obOut) == FUNC_ERROR)
+	{
+		LINK_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+	if (entries.count > 0 && write_output(stage, entName, &entOut) == FUNC_ERROR)
+	{
+		remove(obName);
+		LINK_CLOSE
+		return QUIT_UPON_ERROR;
+	}
+
+	printf(">>> %d files were linked into an Object file (.ob).\n", unitCount);
+	if (entries.count > 0)
+		printf(">>> An Entry file (.ent) was added to the directory.\n");
+
+	LINK_CLOSE
+	return SUCCESS;
+}
+
+/* ___Helper functions___ */
+
+/* Reads the command line options, which are given before the files.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - argc, argv: The command line arguments.
+   - outName: Set to the base name of the output files, if one was given.
+
+   Returns:
+   - The index of the first file in argv.
+   - -1 (FUNC_ERROR) if an option was not recognized.
+*/
+int parse_link_options(const errStage *stage, int argc, char *argv[], char **outName)
+{
+	int index;
+
+	for (index = 1; index < argc && argv[index][0] == '-'; index++)
+	{
+		if (strcmp(argv[index], OPT_OUTPUT) == 0 && index + 1 < argc)
+			*outName = argv[++index];
+		else
+		{
+			err_wo_line(stage, linkErrList[LINK_ERR_UNKNOWN_OPTION], argv[index]);
+			return FUNC_ERROR;
+		}
+	}
+	return index;
+}
+
+/* Places the sections of the files in the linked image - all of the code sections, then all of the data sections.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - units: The files, in the order of the arguments.
+   - unitCount: The number of files.
+
+   Returns:
+   - 1 (TRUE) if the image fits in the memory.
+   - 0 (FALSE) otherwise.
+*/
+int layout_units(const errStage *stage, linkUnit units[], int unitCount)
+{
+	int index,
+		address = IMAGE_OFFSET;
+
+	for (index = 0; index < unitCount; index++)
+	{
+		units[index].codeBase = address;
+		address += units[index].image.IC;
+	}
+	for (index = 0; index < unitCount; index++)
+	{
+		units[index].dataBase = address;
+		address += units[index].image.DC;
+	}
+
+	if (address > RAM_SIZE)
+	{
+		err_wo_line(stage, linkErrList[LINK_ERR_IMAGE_OVERFLOW], NULL);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* Translates an address of a file to its address in the linked image.
+   Parameters:
+   - unit: The file.
+   - address: The address, as the file was assembled.
+
+   Returns:
+   - The linked address.
+   - -1 (FUNC_ERROR) if the address is outside of the file's image.
+*/
+int relocate_address(linkUnit *unit, int address)
+{
+	int index = address - IMAGE_OFFSET;
+
+	if (index < 0 || index >= unit->image.IC + unit->image.DC)
+		return FUNC_ERROR;
+
+	return (index < unit->image.IC) ? unit->codeBase + index : unit->dataBase + index - unit->image.IC;
+}
+
+/* Moves the addresses of the relocatable words of a file's code section to the linked image.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - unit: The file.
+
+   Returns:
+   - 1 (TRUE) if all of the addresses were moved.
+   - 0 (FALSE) if an address is outside of the file's image.
+
+   Notes:
+   - The data section holds plain values, whose A, R, E bits are meaningless, so it is left as it is.
+*/
+int relocate_unit(const errStage *stage, linkUnit *unit)
+{
+	int index,
+		address;
+
+	char spec[MAX_LINE_LENGTH + 1];
+
+	for (index = 0; index < unit->image.IC; index++)
+	{
+		if ((unit->image.words[index] & ARE_MASK) != RELOCATABLE)
+			continue;
+
+		if ((address = relocate_address(unit, (unit->image.words[index] & WORD_MASK) >> LABEL_ADD_MOVE)) == FUNC_ERROR)
+		{
+			sprintf(spec, "%d", (unit->image.words[index] & WORD_MASK) >> LABEL_ADD_MOVE);
+			err_with_line(stage, index + 2, unit->image.obName, linkErrList[LINK_ERR_ADDRESS_RANGE], spec); /* after the header */
+			return FALSE;
+		}
+		unit->image.words[index] = (short int)((address << LABEL_ADD_MOVE) | RELOCATABLE);
+	}
+	return TRUE;
+}
+
+/* Finds the slot of an entry's name in the entry table's hash index, or the empty slot where it should be placed.
+   Parameters:
+   - entries: The entry table.
+   - name: The id of the entry's name in the string pool.
+
+   Returns:
+   - The index of the slot.
+*/
+int entry_slot(entryTable *entries, int name)
+{
+	int index = (int)(ID_HASH(name) & (entries->slotCount - 1));
+
+	while (entries->slots[index] != EMPTY_SLOT && entries->entries[entries->slots[index]].name != name)
+		index = (index + 1) & (entries->slotCount - 1); /* linear probing */
+
+	return index;
+}
+
+/* Looks an entry up by its name.
+   Parameters:
+   - entries: The entry table.
+   - name: The name to look for.
+
+   Returns:
+   - A pointer to the entry.
+   - NULL if no file has an entry by that name.
+*/
+linkEntry *find_entry(entryTable *entries, const char *name)
+{
+	int id,
+		index;
+
+	if (entries->count == 0 || (id = find_name(entries->names, name)) == EMPTY_SLOT)
+		return NULL;
+
+	index = entries->slots[entry_slot(entries, id)];
+	return (index == EMPTY_SLOT) ? NULL : &entries->entries[index];
+}
+
+/* Adds an entry to the entry table.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - entries: The entry table.
+   - name: The entry's name.
+   - address: The entry's linked address.
+   - unit: The index of the file that defined it.
+
+   Returns:
+   - 1 (TRUE) if the entry was added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int add_entry(const errStage *stage, entryTable *entries, const char *name, int address, int unit)
+{
+	linkEntry *newEntry;
+
+	int id = intern_name(entries->names, name);
+
+	if (id == FUNC_ERROR)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return FUNC_ERROR;
+	}
+
+	/* growing the entries array */
+	if (entries->count == entries->capacity)
+	{
+		int newCapacity = (entries->capacity == 0) ? ENTRY_TABLE_INIT_SIZE : entries->capacity * 2;
+
+		linkEntry *temp = (linkEntry *)realloc(entries->entries, newCapacity * sizeof(linkEntry));
+		if (temp == NULL)
+		{
+			err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+			return FUNC_ERROR;
+		}
+		entries->entries = temp;
+		entries->capacity = newCapacity;
+	}
+
+	/* growing the hash index, and rehashing the existing entries */
+	if ((entries->count + 1) * 2 > entries->slotCount)
+	{
+		int index,
+			newSlotCount = (entries->slotCount == 0) ? 2 * ENTRY_TABLE_INIT_SIZE : entries->slotCount * 2;
+
+		int *temp = (int *)malloc(newSlotCount * sizeof(int));
+		if (temp == NULL)
+		{
+			err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+			return FUNC_ERROR;
+		}
+		free(entries->slots);
+		entries->slots = temp;
+		entries->slotCount = newSlotCount;
+
+		for (index = 0; index < newSlotCount; index++)
+			entries->slots[index] = EMPTY_SLOT;
+
+		for (index = 0; index < entries->count; index++)
+			entries->slots[entry_slot(entries, entries->entries[index].name)] = index;
+	}
+
+	newEntry = &entries->entries[entries->count];
+	newEntry->name = id;
+	newEntry->address = address;
+	newEntry->unit = unit;
+
+	entries->slots[entry_slot(entries, id)] = entries->count++;
+
+	return TRUE;
+}
+
+/* Adds the entries of a file's .ent file to the global entry table, at their linked addresses.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - units: The files.
+   - unit: The index of the file.
+   - entries: The entry table.
+
+   Returns:
+   - 1 (TRUE) if the entries were added (a file without a .ent file has none).
+   - 0 (FALSE) if a line is invalid, or an entry was already defined by another file.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int read_ent(const errStage *stage, linkUnit units[], int unit, entryTable *entries)
+{
+	sourceFile ent;
+	lineSlice line;
+	linkEntry *existing;
+
+	char name[MAX_LINE_LENGTH + 1],
+		*entName;
+
+	int lineIndex = 0,
+		address,
+		res = TRUE;
+
+	if ((entName = add_ext(units[unit].image.baseName, ".ent")) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return FUNC_ERROR;
+	}
+	if (open_source(entName, &ent) == FUNC_ERROR)
+	{
+		free(entName);
+		return TRUE;
+	}
+
+	while (res != FUNC_ERROR && next_line(&ent, &line))
+	{
+		lineIndex++;
+		if (line.len == 0)
+			continue;
+
+		if (!parse_symbol_line(&line, name, &address))
+		{
+			err_with_line(stage, lineIndex, entName, objErrList[OBJ_ERR_INVALID_SYMBOL_LINE], NULL);
+			res = FALSE;
+		}
+		else if ((address = relocate_address(&units[unit], address)) == FUNC_ERROR)
+		{
+			err_with_line(stage, lineIndex, entName, linkErrList[LINK_ERR_ADDRESS_RANGE], name);
+			res = FALSE;
+		}
+		else if ((existing = find_entry(entries, name)) != NULL)
+		{
+			err_with_line(stage, lineIndex, entName, linkErrList[LINK_ERR_DUPLICATE_ENTRY], name);
+			fprintf(stderr, "\tIt is also an entry of \"%s\".\n", units[existing->unit].image.baseName);
+			res = FALSE;
+		}
+		else if (add_entry(stage, entries, name, address, unit) == FUNC_ERROR)
+			res = FUNC_ERROR;
+	}
+
+	close_source(&ent);
+	free(entName);
+	return res;
+}
+
+/* Patches the extern references of a file, listed in its .ext file, with the linked addresses of the entries.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - units: The files.
+   - unit: The index of the file.
+   - entries: The global entry table.
+
+   Returns:
+   - 1 (TRUE) if all of the references were patched (a file without a .ext file has none, its external words are left to find_unpatched).
+   - 0 (FALSE) if a line is invalid, or a label is not an entry of any of the files.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+
+   Notes:
+   - A patched word points into the linked image, so it is marked as relocatable (R), like a word of a label of the same file.
+*/
+int resolve_ext(const errStage *stage, linkUnit units[], int unit, entryTable *entries)
+{
+	sourceFile ext;
+	lineSlice line;
+	linkEntry *entry;
+	linkUnit *current = &units[unit];
+
+	char name[MAX_LINE_LENGTH + 1],
+		*extName;
+
+	int lineIndex = 0,
+		address,
+		res = TRUE;
+
+	if ((extName = add_ext(current->image.baseName, ".ext")) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return FUNC_ERROR;
+	}
+	if (open_source(extName, &ext) == FUNC_ERROR)
+	{
+		free(extName);
+		return TRUE;
+	}
+
+	while (next_line(&ext, &line))
+	{
+		lineIndex++;
+		if (line.len == 0)
+			continue;
+
+		if (!parse_symbol_line(&line, name, &address))
+		{
+			err_with_line(stage, lineIndex, extName, objErrList[OBJ_ERR_INVALID_SYMBOL_LINE], NULL);
+			res = FALSE;
+			continue;
+		}
+
+		/* extern references are only found in the code section */
+		address -= IMAGE_OFFSET;
+		if (address < 0 || address >= current->image.IC)
+		{
+			err_with_line(stage, lineIndex, extName, linkErrList[LINK_ERR_ADDRESS_RANGE], name);
+			res = FALSE;
+		}
+		else if ((current->image.words[address] & ARE_MASK) != EXTERNAL)
+		{
+			err_with_line(stage, lineIndex, extName, linkErrList[LINK_ERR_NOT_EXTERNAL], name);
+			res = FALSE;
+		}
+		else if ((entry = find_entry(entries, name)) == NULL)
+		{
+			err_with_line(stage, lineIndex, extName, linkErrList[LINK_ERR_UNRESOLVED_EXTERN], name);
+			res = FALSE;
+		}
+		else
+			current->image.words[address] = (short int)((entry->address << LABEL_ADD_MOVE) | RELOCATABLE);
+	}
+
+	close_source(&ext);
+	free(extName);
+	return res;
+}
+
+/* Reports the words of a file's code section that are still marked as external once its extern references were patched.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - unit: The file.
+
+   Returns:
+   - 1 (TRUE) if no word is left marked as external.
+   - 0 (FALSE) otherwise, every one of them is reported.
+*/
+int find_unpatched(const errStage *stage, linkUnit *unit)
+{
+	int index,
+		res = TRUE;
+
+	char spec[MAX_LINE_LENGTH + 1];
+
+	for (index = 0; index < unit->image.IC; index++)
+	{
+		if ((unit->image.words[index] & ARE_MASK) != EXTERNAL)
+			continue;
+
+		sprintf(spec, "%d", IMAGE_OFFSET + index);
+		err_with_line(stage, index + 2, unit->image.obName, linkErrList[LINK_ERR_UNPATCHED_EXTERN], spec); /* after the header */
+		res = FALSE;
+	}
+	return res;
+}
+
+/* Frees the memory allocated for the entry table, leaving it empty.
+   Parameters:
+   - entries: The entry table.
+*/
+void free_entry_table(entryTable *entries)
+{
+	free(entries->entries);
+	free(entries->slots);
+
+	entries->entries = NULL;
+	entries->slots = NULL;
+	entries->count = entries->capacity = entries->slotCount = 0;
+}
+
+/* Frees the memory allocated for the files.
+   Parameters:
+   - units: The files (may be NULL).
+   - unitCount: The number of files.
+*/
+void free_link_units(linkUnit units[], int unitCount)
+{
+	int index;
+
+	if (units == NULL)
+		return;
+
+	for (index = 0; index < unitCount; index++)
+		free_object_image(&units[index].image);
+	free(units);
+}
+
+/*___Error list___ */
+const char *linkErrList[] =
+{
+	"No object files were given as arguments (usage: linker [-o <output>] <files>)",
+	"Unrecognized command line option (usage: linker [-o <output>] <files>)",
+	"The following address is outside of the file's image",
+	"The word at the following address is not marked as external",
+	"The following entry is defined in more than one file",
+	"The following extern label is not an entry of any of the files",
+	"The linked image does not fit in the memory",
+	"The word at the following address is marked as external, but no .ext line refers to it"
+};
@@ -0,0 +1,91 @@
+/* ___The linker's library___ */
+#ifndef LINKER_H
+#define LINKER_H
+
+/* ___Include___ */
+#include "object_file.h"
+
+/* ___Definitions___ */
+#define LINK_MIN_FILES 1
+#define OPT_OUTPUT "-o"
+#define DEFAULT_OUTPUT "linked"
+#define ENTRY_TABLE_INIT_SIZE 64
+
+/* ___Macros___ */
+#define LINK_CLOSE                                 \
+	do                                             \
+	{                                              \
+		free_link_units(units, unitCount);         \
+		free_entry_table(&entries);                \
+		free_string_pool(&names);                  \
+		free(data.words);                          \
+		free_output_buffer(&obOut);                \
+		free_output_buffer(&entOut);               \
+		if (obName != NULL)                        \
+			free(obName);                          \
+		if (entName != NULL)                       \
+			free(entName);                         \
+	} while (0);
+
+/* ___Enums___ */
+/* Enum defining error indices related to the linker. */
+/* prefix 'LINK' indicates linker context */
+enum linkErrIndex
+{
+	LINK_ERR_MISSING_ARGS,		 /* No object files were given */
+	LINK_ERR_UNKNOWN_OPTION,	 /* Unrecognized command line option */
+	LINK_ERR_ADDRESS_RANGE,		 /* An address outside of the file's image */
+	LINK_ERR_NOT_EXTERNAL,		 /* An extern reference to a word that is not marked as external */
+	LINK_ERR_DUPLICATE_ENTRY,	 /* The same entry in more than one file */
+	LINK_ERR_UNRESOLVED_EXTERN,	 /* An extern label that no file has as an entry */
+	LINK_ERR_IMAGE_OVERFLOW,	 /* The linked image does not fit in the memory */
+	LINK_ERR_UNPATCHED_EXTERN	 /* A word marked as external that no .ext line refers to */
+};
+
+/* ___Typedef___ */
+/* an assembled file, and where its sections are placed in the linked image */
+typedef struct linkUnit
+{
+	objectImage image; /* the file, as it was assembled */
+	int codeBase,	   /* the linked address of the first code word */
+		dataBase;	   /* the linked address of the first data word */
+} linkUnit;
+
+typedef struct linkEntry
+{
+	int name; /* id in the string pool */
+	int address, /* in the linked image */
+		unit;	 /* the file that defined it */
+} linkEntry;
+
+/* the global entry table - the entries of all of the files, indexed by an open addressing hash table */
+typedef struct entryTable
+{
+	linkEntry *entries; /* in order of the files, and of their .ent files */
+	int count,
+		capacity;
+	int *slots; /* indices of entries, keyed by name id */
+	int slotCount;
+	stringPool *names;
+} entryTable;
+
+/* ___Constants___ */
+extern const char *linkErrList[];
+
+/* ___Prototypes___*/
+int parse_link_options(const errStage *stage, int argc, char *argv[], char **outName);
+int layout_units(const errStage *stage, linkUnit units[], int unitCount);
+int relocate_address(linkUnit *unit, int address);
+int relocate_unit(const errStage *stage, linkUnit *unit);
+int entry_slot(entryTable *entries, int name);
+linkEntry *find_entry(entryTable *entries, const char *name);
+int add_entry(const errStage *stage, entryTable *entries, const char *name, int address, int unit);
+int read_ent(const errStage *stage, linkUnit units[], int unit, entryTable *entries);
+int resolve_ext(const errStage *stage, linkUnit units[], int unit, entryTable *entries);
+int find_unpatched(const errStage *stage, linkUnit *unit);
+void free_entry_table(entryTable *entries);
+void free_link_units(linkUnit units[], int unitCount);
+int write_ob(short int codeImage[], int IC, dataBuffer *data, outputBuffer *ob);
+int add_symbol_record(outputBuffer *out, const char *name, int address, int binary);
+
+#endif
@@ -0,0 +1,180 @@
+#include "object_file.h"
+
+/* ___Reading the files made by the assembler, for the tools that take them___ */
+
+/* Decodes a memory word from its base 4 encoding.
+   Parameters:
+   - symbols: The symbols of the word, its 2 leftmost bits first.
+   - len: The number of symbols.
+
+   Returns:
+   - The word.
+   - -1 (FUNC_ERROR) if there are not WORD_SYMBOLS symbols, or one of them is not a base 4 symbol.
+*/
+int decode_word_4(const char *symbols, int len)
+{
+	int index,
+		word = 0;
+
+	const char *symbol;
+
+	if (len != WORD_SYMBOLS)
+		return FUNC_ERROR;
+
+	for (index = 0; index < len; index++)
+	{
+		if (symbols[index] == '\0' || (symbol = strchr(BASE4_SYMBOLS, symbols[index])) == NULL)
+			return FUNC_ERROR;
+
+		word = (word << 2) | (int)(symbol - BASE4_SYMBOLS);
+	}
+	return word;
+}
+
+/* Copies a line into a null terminated buffer.
+   Parameters:
+   - line: The line.
+   - buffer: A buffer of MAX_LINE_LENGTH + 1 characters.
+
+   Returns:
+   - 1 (TRUE) if the line was copied.
+   - 0 (FALSE) if the line is longer than the buffer.
+*/
+int copy_line(lineSlice *line, char *buffer)
+{
+	if (line->len > MAX_LINE_LENGTH)
+		return FALSE;
+
+	memcpy(buffer, line->start, line->len);
+	buffer[line->len] = '\0';
+	return TRUE;
+}
+
+/* Reads the words of an assembled file from its .ob file.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - image: The file's image, whose base name is set.
+
+   Returns:
+   - 1 (TRUE) if the file was read.
+   - 0 (FALSE) if the file is not a valid object file.
+   - -1 (FUNC_ERROR) if the file could not be opened, or there was an error during memory allocation.
+*/
+int read_ob(const errStage *stage, objectImage *image)
+{
+	sourceFile ob;
+	lineSlice line;
+
+	char buffer[MAX_LINE_LENGTH + 1],
+		symbols[MAX_LINE_LENGTH + 1],
+		extra;
+
+	int lineIndex = 1,
+		count = 0,
+		address,
+		word,
+		res = TRUE;
+
+	if ((image->obName = add_ext(image->baseName, ".ob")) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return FUNC_ERROR;
+	}
+	if (open_source(image->obName, &ob) == FUNC_ERROR)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], image->obName);
+		return FUNC_ERROR;
+	}
+
+	/* the header - the IC and the DC */
+	if (!next_line(&ob, &line) || !copy_line(&line, buffer) ||
+		sscanf(buffer, "%d %d %c", &image->IC, &image->DC, &extra) != 2 ||
+		image->IC < 0 || image->DC < 0 || image->IC + image->DC > IMAGE_WORDS)
+	{
+		err_with_line(stage, lineIndex, image->obName, objErrList[OBJ_ERR_INVALID_HEADER], NULL);
+		close_source(&ob);
+		return FALSE;
+	}
+
+	if ((image->words = (short int *)malloc((image->IC + image->DC + 1) * sizeof(short int))) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		close_source(&ob);
+		return FUNC_ERROR;
+	}
+
+	/* every line is an address followed by a word, the addresses counting up from IMAGE_OFFSET */
+	while (next_line(&ob, &line))
+	{
+		int fields;
+
+		lineIndex++;
+		fields = copy_line(&line, buffer) ? sscanf(buffer, "%d %s %c", &address, symbols, &extra) : 0;
+
+		if (fields == EOF)
+			continue; /* an empty line */
+
+		if (count == image->IC + image->DC)
+		{
+			err_wo_line(stage, objErrList[OBJ_ERR_WORD_COUNT], image->obName);
+			res = FALSE;
+			break;
+		}
+		if (fields != 2 || address != IMAGE_OFFSET + count || (word = decode_word_4(symbols, strlen(symbols))) == FUNC_ERROR)
+		{
+			err_with_line(stage, lineIndex, image->obName, objErrList[OBJ_ERR_INVALID_WORD_LINE], NULL);
+			res = FALSE;
+			break;
+		}
+		image->words[count++] = (short int)word;
+	}
+
+	if (res == TRUE && count != image->IC + image->DC)
+	{
+		err_wo_line(stage, objErrList[OBJ_ERR_WORD_COUNT], image->obName);
+		res = FALSE;
+	}
+
+	close_source(&ob);
+	return res;
+}
+
+/* Reads a line of a .ent or .ext file - a label followed by an address.
+   Parameters:
+   - line: The line.
+   - name: A buffer of MAX_LINE_LENGTH + 1 characters, for the label.
+   - address: Set to the address.
+
+   Returns:
+   - 1 (TRUE) if the line is valid.
+   - 0 (FALSE) otherwise.
+*/
+int parse_symbol_line(lineSlice *line, char *name, int *address)
+{
+	char buffer[MAX_LINE_LENGTH + 1],
+		extra;
+
+	return copy_line(line, buffer) && sscanf(buffer, "%s %d %c", name, address, &extra) == 2;
+}
+
+/* Frees the memory allocated for a file's image.
+   Parameters:
+   - image: The file's image.
+*/
+void free_object_image(objectImage *image)
+{
+	free(image->words);
+	free(image->obName);
+
+	image->words = NULL;
+	image->obName = NULL;
+}
+
+/*___Error list___ */
+const char *objErrList[] =
+{
+	"The object file does not start with a valid header",
+	"The line is not an address followed by an encoded word",
+	"The number of words does not match the header of the following file",
+	"The line is not a label followed by an address"
+};
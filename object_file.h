@@ -0,0 +1,41 @@
+/* ___The object file reader's library___ */
+#ifndef OBJECT_FILE_H
+#define OBJECT_FILE_H
+
+/* ___Include___ */
+#include "general_lib.h"
+#include "source_reader.h"
+
+/* ___Enums___ */
+/* Enum defining error indices related to reading the files made by the assembler. */
+/* prefix 'OBJ' indicates object file context */
+enum objErrIndex
+{
+	OBJ_ERR_INVALID_HEADER,		 /* The first line of an object file is not a valid header */
+	OBJ_ERR_INVALID_WORD_LINE,	 /* An object file line is not an address followed by an encoded word */
+	OBJ_ERR_WORD_COUNT,			 /* The number of words does not match the header */
+	OBJ_ERR_INVALID_SYMBOL_LINE	 /* A .ent or .ext line is not a label followed by an address */
+};
+
+/* ___Constants___ */
+extern const char *objErrList[];
+
+/* ___Typedef___ */
+/* the image of an assembled file, as read from its .ob file */
+typedef struct objectImage
+{
+	char *baseName, /* the argument, without an extension */
+		*obName;	/* for diagnostics */
+	int IC,
+		DC;
+	short int *words; /* the code image followed by the data image */
+} objectImage;
+
+/* ___Prototypes___*/
+int decode_word_4(const char *symbols, int len);
+int copy_line(lineSlice *line, char *buffer);
+int read_ob(const errStage *stage, objectImage *image);
+int parse_symbol_line(lineSlice *line, char *name, int *address);
+void free_object_image(objectImage *image);
+
+#endif
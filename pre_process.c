@@ -1,183 +1,252 @@
 #include "pre_process.h"
 
 /* ___The pre-processor___ */
-/* Returns:
-   - 0 (SUCCESS): The pre-processing stage was completed with no errors, and the AM file was created.
-   - -1 (QUIT_UPON_ERROR): An error occurred (related to malloc, files, syntax errors in the source file, etc.), and the AM file is to be deleted.
-   - -2 (DETECT_MORE_ERRORS): A line longer than the buffer was detected, the AM file was created, but the assembler will not make additional output 	 			     files.
+/* The macro-expanded lines are added to amLines, which the first pass reads from,
+   and are written to an AM file only if writeAm is set.
+   The source is the one load_source read, so it can be read once for the output cache as well.
+   OUTPUT_AM is added to outputs if the AM file was written, and its contents are kept in kept (unless it is NULL).
+   The errors are kept in diags (or printed if it is NULL), and the files written are counted in io, unless it is NULL.
+   Returns:
+   - 0 (SUCCESS): The pre-processing stage was completed with no errors.
+   - -1 (QUIT_UPON_ERROR): An error occurred (related to malloc, files, syntax errors in the source file, etc.), and no AM file is made.
+   - -2 (DETECT_MORE_ERRORS): A line longer than the buffer was detected, the lines were expanded, but the assembler will not make additional output 	 			     files.
 */
-int pre_process(char *baseName, char *resNames)
+int pre_process(diagList *diags, char *baseName, sourceFile *ip, resNamesIndex *resNames, stringPool *names, lineBuffer *amLines, int writeAm, int *outputs, outputBuffer kept[], ioCounts *io)
 {
-	/* ___Declarations___ */
-
-	/* a flag to indicate the current macro definition stage */
-	int mcrDef = OUTSIDE_MCR;
-
-	/* macros will be stored in a linked list */
-	mcrNode *head = NULL;
-
-	/* input, output file pointers */
-	FILE *ip = NULL, *op = NULL;
-
-	/* a long to record file positioning */
-	long filePos = 0;
-
-	/* additional */
-	int lineIndex = 0,
-		mcrLineCount = 0,
-		longLineFlag = FALSE, /* a flag indicating that the current line is longer than the buffer */
-		longLineCount = 0;	  /* counts the total number of long lines */
+	int res;
 
-	const char *stage = "pre processing";
+	errStage ppStage;
+	const errStage *stage = &ppStage;
 	char *ipName = NULL,
-		 *opName = NULL,
-		 *tempWord = NULL,
-		 sourceLine[MAX_LINE_LENGTH + 1] = "",
-		 lineCopy[MAX_LINE_LENGTH + 1] = "";
+		 *opName = NULL;
+
+	ppStage.name = "pre processing";
+	ppStage.diags = diags;
+	ppStage.io = io;
 
 	/* ___Adding extensions to the file names___ */
 	if ((ipName = add_ext(baseName, ".as")) == NULL ||
-		(opName = add_ext(baseName, ".am")) == NULL)
+		(writeAm && (opName = add_ext(baseName, ".am")) == NULL))
 	{
 		/* malloc failed */
 		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
-		PP_CLOSE(head, FALSE, resNames)
+		PP_FILES_CLOSE
 		return QUIT_UPON_ERROR;
 	}
 
-	/* ___Opening the files___ */
-	/* input: for reading */
-	if ((ip = fopen(ipName, "r")) == NULL)
+	if ((res = expand_macros(diags, ipName, ip, resNames, names, amLines)) == QUIT_UPON_ERROR)
 	{
-		/* file opening failed */
-		err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], ipName);
-		PP_CLOSE(head, FALSE, resNames)
+		/* an AM file left from an earlier run would not match the source */
+		PP_FILES_CLOSE_AND_REMOVE_AM
 		return QUIT_UPON_ERROR;
 	}
-	/* output: for writing */
-	if ((op = fopen(opName, "w")) == NULL)
+
+	/* ___Writing the .am file, if it was asked for___ */
+	if (writeAm && write_am(stage, opName, amLines, kept) == FUNC_ERROR)
 	{
-		/* file making failed */
-		err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], opName);
-		PP_CLOSE(head, FALSE, resNames)
+		PP_FILES_CLOSE
 		return QUIT_UPON_ERROR;
 	}
 
-	/* ___Processing the lines of the source file___ */
-	while (fgets(sourceLine, MAX_LINE_LENGTH + 1, ip) != NULL)
+	PP_FILES_CLOSE
+
+	if (res == SUCCESS && writeAm)
+		*outputs |= OUTPUT_AM;
+	return res;
+}
+
+/* Reads a source into memory whole, for the pre-processor.
+   Parameters:
+   - diags: Where the errors are kept, or NULL to print them.
+   - baseName: The file's name, without the .as extension.
+   - fromStdin: Whether the source is read from the standard input, rather than the .as file.
+   - ip: Where the source is put, to be closed by the caller.
+   - io: Where the file read is counted, or NULL.
+
+   Returns:
+   - 1 (TRUE) if the source was read.
+   - -1 (FUNC_ERROR) if it could not be read.
+*/
+int load_source(diagList *diags, char *baseName, int fromStdin, sourceFile *ip, ioCounts *io)
+{
+	errStage ppStage;
+	const errStage *stage = &ppStage;
+	char *ipName;
+
+	ppStage.name = "pre processing";
+	ppStage.diags = diags;
+	ppStage.io = io;
+
+	if ((ipName = add_ext(baseName, ".as")) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return FUNC_ERROR;
+	}
+
+	/* ___Opening the file___ */
+	if ((fromStdin ? read_stdin(ip) : open_source(ipName, ip)) == FUNC_ERROR)
+	{
+		/* file opening failed */
+		err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], ipName);
+		free(ipName);
+		return FUNC_ERROR;
+	}
+	count_io(stage, !fromStdin, ip->size, 0);
+
+	free(ipName);
+	return TRUE;
+}
+
+/* Expands the macros of a source that is already in memory, with no access to files.
+   Parameters:
+   - diags: Where the errors are kept, or NULL to print them.
+   - ipName: The source's name, for diagnostics.
+   - ip: The source, read from its current position.
+   - resNames: The reserved names index, whose macro overlay receives the macro names if there were no errors.
+   - names: The string pool the macros' names are interned in.
+   - amLines: The expanded lines.
+
+   Returns:
+   - The same values as pre_process.
+*/
+int expand_macros(diagList *diags, char *ipName, sourceFile *ip, resNamesIndex *resNames, stringPool *names, lineBuffer *amLines)
+{
+	/* ___Declarations___ */
+
+	/* a flag to indicate the current macro definition stage */
+	int mcrDef = OUTSIDE_MCR;
+
+	/* macros will be stored in a hash table, the one being defined is the last entry */
+	mcrTable mcrs = {NULL, 0, 0, NULL, 0, NULL};
+
+	lineSlice line;
+	lineRecord tokens;
+
+	/* additional */
+	int lineIndex = 0,
+		mcrLineIndex = 0, /* the line of the mcr command of the macro being defined */
+		funcRes = 0,
+		longLineFlag = FALSE, /* a flag indicating that the current line is longer than the buffer */
+		longLineCount = 0;	  /* counts the total number of long lines */
+
+	errStage ppStage;
+	const errStage *stage = &ppStage;
+	char *tempWord = NULL;
+
+	ppStage.name = "pre processing";
+	ppStage.diags = diags;
+	ppStage.io = NULL;
+	mcrs.names = names;
+
+	/* ___Processing the lines of the source file, until there are as many errors as are kept___ */
+	while (!DIAG_LIMIT_REACHED(diags) && next_line(ip, &line))
 	{
 		lineIndex++;
 
 		/* detecting if the source line is longer than the buffer */
 		/* if it is, the line will not be proccessed */
-		if (is_long_line(ERR_DETAILS, sourceLine, MAX_LINE_LENGTH, ip))
+		if (is_long_line(ERR_DETAILS, &line))
 			longLineFlag = TRUE;
 
-		/* processing the line's contents */
-		remove_edge_ws(sourceLine);
-		strcpy(lineCopy, sourceLine);
-
-		/* tempWord will initially hold the first token of the line */
-		tempWord = strtok(lineCopy, DELIM);
+		/* processing the line's contents in place, without the surrounding white spaces */
+		while (line.len > 0 && isspace((unsigned char)line.start[0]))
+		{
+			line.start++;
+			line.len--;
+		}
+		while (line.len > 0 && isspace((unsigned char)line.start[line.len - 1]))
+			line.len--;
 
 		/* will process only if the line is of valid lenght, not empty, and not a comment */
-		if (tempWord != NULL && tempWord[0] != ';' && !longLineFlag)
+		if (line.len > 0 && line.start[0] != ';' && !longLineFlag)
 		{
+			tokenize_line(&line, &tokens);
+
+			/* tempWord will hold the first token of the line, a line that starts with a label has no macro commands */
+			tempWord = (tokens.label.text == NULL) ? tokens.element.text : NULL;
+
 			switch (mcrDef)
 			{
 			case OUTSIDE_MCR:
 			{
-				if (strcmp(tempWord, "mcr") == 0)
+				if (tempWord != NULL && strcmp(tempWord, "mcr") == 0)
 				{ /* an mcr definition command was found */
-					tempWord = strtok(NULL, DELIM);
-					if (tempWord == NULL)
+					tempWord = tokens.operands[0].text;
+					if (tokens.operandCount == 0)
 					{
 						err_with_line(ERR_DETAILS, ppErrList[PP_ERR_MISSING_MCR_NAME], NULL);
-						PP_CLOSE_AND_REMOVE_AM
+						PP_CLOSE(mcrs, FALSE, resNames)
 						return QUIT_UPON_ERROR;
 					}
-					if (strtok(NULL, DELIM) != NULL)
+					/* the name must be all of the arguments */
+					if (tokens.operands[0].len != tokens.args.len)
 					{
 						err_with_line(ERR_DETAILS, ppErrList[PP_ERR_EXTRA_MCR_TEXT], NULL);
-						PP_CLOSE_AND_REMOVE_AM
+						PP_CLOSE(mcrs, FALSE, resNames)
 						return QUIT_UPON_ERROR;
 					}
 					if (valid_mcr(ERR_DETAILS, tempWord, resNames) != TRUE)
 					{
-						PP_CLOSE_AND_REMOVE_AM
+						PP_CLOSE(mcrs, FALSE, resNames)
 						return QUIT_UPON_ERROR;
 					}
 					/* otherwise, the macro name is valid */
-					/* entering the line counting stage */
-					mcrDef = COUNTING_MCR_LINES;
-					filePos = ftell(ip);
-					mcrLineCount = 0;
-
-					/* setting the new macro as the head of the list */
-					head = new_mcr(stage, tempWord, head);
-					if (head == NULL)
+					/* the following lines will be added to the macro until the endmcr command */
+					mcrDef = INSIDE_MCR;
+					mcrLineIndex = lineIndex;
+
+					/* adding the new macro to the table */
+					if (new_mcr(stage, tempWord, &mcrs) == NULL)
 					{
-						PP_CLOSE_AND_REMOVE_AM
+						PP_CLOSE(mcrs, FALSE, resNames)
 						return QUIT_UPON_ERROR;
 					}
 				}
-				else if (print_if_mcr(head, tempWord, op))
+				else if (tempWord != NULL && (funcRes = print_if_mcr(&mcrs, tempWord, amLines)) != FALSE)
 				{ /* mcr name was found */
-					continue;
-				}
-				else
-				{ /* copy the line to the am file normally */
-					fprintf(op, "%s\n", sourceLine);
-				}
-				break;
-			}
-			case COUNTING_MCR_LINES:
-			{
-				if (strcmp(tempWord, "endmcr") == 0)
-				{
-					if (strtok(NULL, DELIM) != NULL)
+					if (funcRes == FUNC_ERROR)
 					{
-						err_with_line(ERR_DETAILS, ppErrList[PP_ERR_EXTRA_ENDMCR_TEXT], NULL);
-						PP_CLOSE_AND_REMOVE_AM
+						err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+						PP_CLOSE(mcrs, FALSE, resNames)
 						return QUIT_UPON_ERROR;
 					}
-					/* the line counting is done */
-					/* proceeding the the line addition stage */
-					mcrDef = ADDING_MCR_LINES;
-					filePos = fseek(ip, filePos, SEEK_SET);
-					head->lineCount = mcrLineCount;
-
-					/* allocating memory for the macro's lines */
-					head->lines = (char(*)[MAX_LINE_LENGTH + 1]) malloc(mcrLineCount * (MAX_LINE_LENGTH + 1) * sizeof(char));
-					if (head->lines == NULL)
+					continue;
+				}
+				else
+				{ /* copy the line to the expanded lines normally */
+					if (add_line(amLines, &line) == FUNC_ERROR)
 					{
 						err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
-						PP_CLOSE_AND_REMOVE_AM
+						PP_CLOSE(mcrs, FALSE, resNames)
 						return QUIT_UPON_ERROR;
 					}
-
-					/* resetting the line count which will be used as an index in the line addition process */
-					mcrLineCount = 0;
 				}
-				else
-					mcrLineCount++;
 				break;
 			}
-			case ADDING_MCR_LINES:
+			case INSIDE_MCR:
 			{
 				/* returning to normal processing after finding the endmcr command */
-				if (strcmp(tempWord, "endmcr") == 0)
+				if (tempWord != NULL && strcmp(tempWord, "endmcr") == 0)
 				{
+					if (tokens.args.len != 0)
+					{
+						err_with_line(ERR_DETAILS, ppErrList[PP_ERR_EXTRA_ENDMCR_TEXT], NULL);
+						PP_CLOSE(mcrs, FALSE, resNames)
+						return QUIT_UPON_ERROR;
+					}
+					/* the body is complete, it will not grow anymore */
+					fit_line_buffer(&mcrs.entries[mcrs.count - 1].body);
 					mcrDef = OUTSIDE_MCR;
-					filePos = 0;
-					mcrLineCount = 0;
 				}
-				/* else, adding the current line to the macro's line list */
+				/* else, adding the current line to the macro's body */
 				else
 				{
-					strcat(sourceLine, "\n");
-					strcpy(head->lines[mcrLineCount], sourceLine);
-					mcrLineCount++;
+					if (add_line(&mcrs.entries[mcrs.count - 1].body, &line) == FUNC_ERROR)
+					{
+						err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+						PP_CLOSE(mcrs, FALSE, resNames)
+						return QUIT_UPON_ERROR;
+					}
 				}
 				break;
 			}
@@ -187,55 +256,53 @@ int pre_process(char *baseName, char *resNames)
 		}
 
 		/* preparing for the next iteration */
-		strcpy(sourceLine, ""); /* clearing the sourceLine */
 		longLineCount += longLineFlag;
 		longLineFlag = 0;
+	}
+
+	if (DIAG_LIMIT_REACHED(diags))
+	{
+		PP_CLOSE(mcrs, FALSE, resNames)
+		return QUIT_UPON_ERROR;
+	}
 
-		if (feof(ip))
-			break;
+	/* a macro whose definition was not closed would silently swallow the rest of the source */
+	if (mcrDef == INSIDE_MCR)
+	{
+		err_with_line(stage, mcrLineIndex, ipName, ppErrList[PP_ERR_MISSING_ENDMCR], POOL_STR(names, mcrs.entries[mcrs.count - 1].mcrName));
+		PP_CLOSE(mcrs, FALSE, resNames)
+		return QUIT_UPON_ERROR;
 	}
 
-	/* ___Closing all files and freeing allocated memory___ */
-	/* in the case that no errors were detected, the .am file will not be deleted */
-	/* and the names of the existing macros will be added to the reserved names list */
-	PP_CLOSE(head, TRUE, resNames)
+	/* ___Freeing allocated memory___ */
+	/* in the case that no errors were detected, the names of the existing macros will be added to the reserved names list */
+	PP_CLOSE(mcrs, TRUE, resNames)
 
 	if (longLineCount > 0)
 		return DETECT_MORE_ERRORS;
 
-	printf(">>> A Macro-expanded file (.am) was added to the directory.\n");
 	return SUCCESS;
 }
 
 /* ___Helper functions___ */
 
-/* Checks whether a given line is longer than a desired buffer.
+/* Checks whether a given line is longer than the line buffer.
    Parameters:
    - ERR_DETAILS_SIG: Signature for error details, typically including stage, line index, and IP name.
-   - lineToCheck: The line to check for length.
-   - buffer: The desired buffer size.
-   - fp: The file pointer to the input file.
+   - line: The line to check for length.
 
    Returns:
    - 1 (TRUE) if the line is longer than the buffer.
    - 0 (FALSE) if the line is of valid length.
 
    Behavior:
-   - Assumes the line ends with a newline character.
-   - Checks if the last character before the newline is not a newline character, and if the length equals the buffer size.
-   - If the line is longer than the buffer, it flushes excess characters from the file pointer.
+   - The line's length is known, so only the newline character is left out of the check.
 */
-int is_long_line(ERR_DETAILS_SIG, char *lineToCheck, int buffer, FILE *fp)
+int is_long_line(ERR_DETAILS_SIG, lineSlice *line)
 {
-	if (lineToCheck[buffer - 1] != '\n' && strlen(lineToCheck) == buffer)
+	if (line->len > MAX_LINE_LENGTH - 1)
 	{
-		int c;
-
 		err_with_line(ERR_DETAILS, ppErrList[PP_ERR_LONG_LINE], NULL);
-
-		/* flushing excess chars */
-		while ((c = fgetc(fp)) != '\n' && c != EOF)
-			;
 		return TRUE;
 	}
 	return FALSE;
@@ -245,10 +312,10 @@ int is_long_line(ERR_DETAILS_SIG, char *lineToCheck, int buffer, FILE *fp)
    Parameters:
    - ERR_DETAILS_SIG: Signature for error details, typically including stage, line index, and IP name.
    - toCheck: The string to check if it's a valid macro name.
-   - resNames: The file containing reserved names, used for checking if the name is reserved.
+   - resNames: The reserved names index, used for checking if the name is reserved.
 
    Returns:
-   - -1 (FUNC_ERROR) if there was an error opening the reserved names file or another function-related error.
+   - -1 (FUNC_ERROR) if the reserved names index could not be accessed or another function-related error.
    - 1 (TRUE) if the string is a valid macro name.
    - 0 (FALSE) if the string is not a valid macro name.
 
@@ -258,7 +325,7 @@ int is_long_line(ERR_DETAILS_SIG, char *lineToCheck, int buffer, FILE *fp)
    - Checks if the first character of the string is alphabetic.
    - Checks if the rest of the characters are printable.
 */
-int valid_mcr(ERR_DETAILS_SIG, char *toCheck, char *resNames)
+int valid_mcr(ERR_DETAILS_SIG, char *toCheck, resNamesIndex *resNames)
 {
 	int index,
 		len = strlen(toCheck),
@@ -272,7 +339,7 @@ int valid_mcr(ERR_DETAILS_SIG, char *toCheck, char *resNames)
 
 	if (resNameVal == FUNC_ERROR)
 	{
-		err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], resNames);
+		err_wo_line(stage, generalErrList[GEN_ERR_RES_NAMES], NULL);
 		return FUNC_ERROR;
 	}
 
@@ -299,108 +366,212 @@ int valid_mcr(ERR_DETAILS_SIG, char *toCheck, char *resNames)
 	return TRUE;
 }
 
-/* A function that adds a new macro node to the macros' linked list.
+/* Finds the slot of a name id in the macro table's hash index.
+   Parameters:
+   - mcrs: The macro table.
+   - name: The name id to look for.
+
+   Returns:
+   - The index of the slot holding the name's entry, or of the empty slot where it would be placed.
+*/
+int mcr_slot(mcrTable *mcrs, int name)
+{
+	int index = (int)(ID_HASH(name) & (mcrs->slotCount - 1));
+
+	while (mcrs->slots[index] != EMPTY_SLOT && mcrs->entries[mcrs->slots[index]].mcrName != name)
+		index = (index + 1) & (mcrs->slotCount - 1); /* linear probing */
+
+	return index;
+}
+
+/* A function that adds a new macro to the macro table.
    Parameters:
    - stage: A string representing the context or stage where the function is called.
    - name: The name of the macro to be added.
-   - next: Pointer to the next node in the linked list.
+   - mcrs: The macro table.
 
    Returns:
-   - Pointer to the newly created macro node.
-   - NULL if there was an error during node creation.
+   - Pointer to the new macro's entry (valid until the next macro is added).
+   - NULL if there was an error during the addition.
 
    Behavior:
-   - Allocates memory for a new macro node.
-   - Copies the macro's name to the node.
-   - Initializes the line counter to 0.
-   - Sets the next pointer to the provided next node.
-   - Returns a pointer to the new node or NULL if an error occurs.
+   - Interns the macro's name, and grows the entries and the hash index as needed.
+   - Initializes the macro with no lines.
+   - A macro that is defined again replaces the previous definition from then on.
 */
-mcrNode *new_mcr(const char *stage, char *name, mcrNode *next)
+mcrEntry *new_mcr(const errStage *stage, char *name, mcrTable *mcrs)
 {
-	/* new node */
-	mcrNode *newNode = (mcrNode *)malloc(sizeof(mcrNode));
-	if (newNode == NULL)
+	mcrEntry *newEntry;
+
+	int id = intern_name(mcrs->names, name);
+
+	if (id == FUNC_ERROR)
 	{
 		err_wo_line(stage, ppErrList[PP_ERR_MCR_ADD], name);
 		return NULL;
 	}
 
-	/* setting the macro's name */
-	strcpy(newNode->mcrName, name);
+	/* growing the entries array */
+	if (mcrs->count == mcrs->capacity)
+	{
+		int newCapacity = (mcrs->capacity == 0) ? MCR_TABLE_INIT_SIZE : mcrs->capacity * 2;
 
-	/* setting the line counter */
-	newNode->lineCount = 0;
+		mcrEntry *temp = (mcrEntry *)realloc(mcrs->entries, newCapacity * sizeof(mcrEntry));
+		if (temp == NULL)
+		{
+			err_wo_line(stage, ppErrList[PP_ERR_MCR_ADD], name);
+			return NULL;
+		}
+		mcrs->entries = temp;
+		mcrs->capacity = newCapacity;
+	}
 
-	/* setting the next node */
-	newNode->next = next;
+	/* growing the hash index, and rehashing the existing entries */
+	if ((mcrs->count + 1) * 2 > mcrs->slotCount)
+	{
+		int index,
+			newSlotCount = (mcrs->slotCount == 0) ? 2 * MCR_TABLE_INIT_SIZE : mcrs->slotCount * 2;
 
-	return newNode;
+		int *temp = (int *)malloc(newSlotCount * sizeof(int));
+		if (temp == NULL)
+		{
+			err_wo_line(stage, ppErrList[PP_ERR_MCR_ADD], name);
+			return NULL;
+		}
+		free(mcrs->slots);
+		mcrs->slots = temp;
+		mcrs->slotCount = newSlotCount;
+
+		for (index = 0; index < newSlotCount; index++)
+			mcrs->slots[index] = EMPTY_SLOT;
+
+		/* later definitions of the same name take the slot over */
+		for (index = 0; index < mcrs->count; index++)
+			mcrs->slots[mcr_slot(mcrs, mcrs->entries[index].mcrName)] = index;
+	}
+
+	newEntry = &mcrs->entries[mcrs->count];
+	newEntry->mcrName = id;
+	newEntry->body.chars = NULL;
+	newEntry->body.starts = NULL;
+	newEntry->body.size = newEntry->body.capacity = 0;
+	newEntry->body.count = newEntry->body.lineCapacity = 0;
+
+	mcrs->slots[mcr_slot(mcrs, id)] = mcrs->count++;
+
+	return newEntry;
 }
 
 /* A function that checks if a string is a macro's name, and prints its lines to a file if found.
    Parameters:
-   - head: Pointer to the head of the linked list containing macros.
+   - mcrs: The macro table.
    - toCheck: String to check if it's a macro's name.
-   - op: File pointer to the output file where macro lines will be printed.
+   - amLines: The expanded lines, where the macro's lines will be added.
 
    Returns:
-   - 1 (TRUE) if the string is a macro name and its lines are printed.
+   - 1 (TRUE) if the string is a macro name and its lines are added.
    - 0 (FALSE) if the string is not a macro name.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
 
    Behavior:
-   - Iterates through the linked list of macros.
-   - If the string matches a macro's name, prints its lines to the output file.
-   - Returns TRUE if a match is found and lines are printed, otherwise FALSE.
+   - A string that was never interned cannot be a macro's name, otherwise its id is looked up in the hash index.
+   - If the string matches a macro's name, adds its body to the expanded lines with a single copy.
+*/
+int print_if_mcr(mcrTable *mcrs, char *toCheck, lineBuffer *amLines)
+{
+	int entry,
+		name;
+
+	if (mcrs->count == 0 || (name = find_name(mcrs->names, toCheck)) == EMPTY_SLOT)
+		return FALSE;
+
+	if ((entry = mcrs->slots[mcr_slot(mcrs, name)]) == EMPTY_SLOT)
+		return FALSE;
+
+	/* adding the macro's lines to the expanded lines */
+	if (append_lines(amLines, &mcrs->entries[entry].body) == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	return TRUE;
+}
+
+/* Writes the macro-expanded lines to an AM file, staging them in an output buffer so the file is written at once.
+   Parameters:
+   - stage: A string representing the context or stage where the function is called.
+   - opName: The name of the AM file.
+   - amLines: The expanded lines.
+   - kept: Where the file's contents are kept once it is written, or NULL.
+
+   Returns:
+   - 1 (TRUE) if the file was written.
+   - -1 (FUNC_ERROR) if the file could not be made.
 */
-int print_if_mcr(mcrNode *head, char *toCheck, FILE *op)
+int write_am(const errStage *stage, char *opName, lineBuffer *amLines, outputBuffer kept[])
 {
-	mcrNode *current = head;
+	int index,
+		len,
+		res;
+
+	outputBuffer out = {NULL, 0, 0};
 
-	while (current != NULL)
+	/* the lines without their null terminators take less than the line buffer */
+	if (reserve_output(&out, amLines->size) == FUNC_ERROR)
 	{
-		if (strcmp(toCheck, current->mcrName) == 0) /* there is a macro with the same name */
-		{
-			int index;
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return FUNC_ERROR;
+	}
 
-			for (index = 0; index < current->lineCount; index++)
-			{
-				fprintf(op, "%s", current->lines[index]); /* printing the macro's lines to the output file */
-			}
-			return TRUE;
-		}
-		current = current->next;
+	for (index = 0; index < amLines->count; index++)
+	{
+		len = (int)strlen(LINE_AT(amLines, index));
+		memcpy(out.chars + out.size, LINE_AT(amLines, index), len);
+		out.size += len;
 	}
-	return FALSE;
+
+	if ((res = write_output(stage, opName, &out)) == TRUE)
+		keep_output(kept, OUTPUT_AM, &out);
+	free_output_buffer(&out);
+	return res;
 }
 
-/* A function that frees the memory allocated for a linked list of macro nodes.
+/* A function that frees the memory allocated for the macro table.
    Parameters:
-   - head: Pointer to the head of the linked list.
+   - mcrs: The macro table.
    - saveMcrNames: Flag indicating whether to add the macro names to the resNames file -
 		   TRUE if the pre-process stage had no errors.
-   - resNames: The name of the file to append the macro names to if saveMcrNames is true.
+   - resNames: The reserved names index, whose macro overlay receives the macro names if saveMcrNames is true.
 */
-void free_linked_list(mcrNode *head, int saveMcrNames, char *resNames)
+void free_mcr_table(mcrTable *mcrs, int saveMcrNames, resNamesIndex *resNames)
 {
-	mcrNode *current = head,
-			*next;
+	int index;
 
-	FILE *fp = fopen(resNames, "a");
-
-	while (current != NULL)
+	for (index = 0; index < mcrs->count; index++)
 	{
-		/* adding the macro's name to the reserved names list if saveMcrNames is true and fp is not NULL */
-		if (saveMcrNames && fp != NULL)
+		/* adding the macro's name to the reserved names overlay if saveMcrNames is true */
+		if (saveMcrNames && resNames != NULL)
 		{
-			fprintf(fp, "%s\n", current->mcrName);
+			name_set_add(&resNames->mcrs, POOL_STR(mcrs->names, mcrs->entries[index].mcrName));
 		}
-
-		next = current->next;
-		free(current->lines); /* free memory for lines array */
-		free(current);		  /* free memory for current node */
-		current = next;
+		free_line_buffer(&mcrs->entries[index].body); /* free memory for the macro's body */
 	}
 
-	fclose(fp);
+	free(mcrs->entries);
+	free(mcrs->slots);
+	mcrs->entries = NULL;
+	mcrs->slots = NULL;
+	mcrs->count = mcrs->capacity = mcrs->slotCount = 0;
 }
+
+/*___Error list___ */
+const char *ppErrList[] =
+{
+	"The line is longer than 80 characters",
+	"Missing macro name after 'mcr' command",
+	"Detected extranous characters following the macro's name",
+	"The following macro's name is longer than 31 characters",
+	"The following macro's name is conflicting with a reserved name",
+	"The following macro name is invalid",
+	"Unsuccessful macro addition attempt for",
+	"Detected extranous characters following the 'endmcr' command",
+	"The source ended before the 'endmcr' command of the following macro"
+};
@@ -4,36 +4,41 @@
 
 /* ___Include___ */
 #include "general_lib.h"
+#include "source_reader.h"
+#include "first_pass.h"
+
+/* ___Definitions___ */
+#define MCR_TABLE_INIT_SIZE 16
 
 /* ___Macros___ */
-#define PP_CLOSE(head, addMcr, resNames)              \
+#define PP_CLOSE(mcrs, addMcr, resNames)              \
+    do                                                \
+    {                                                 \
+        free_mcr_table(&mcrs, addMcr, resNames);      \
+    } while (0);
+
+#define PP_FILES_CLOSE                                \
     do                                                \
     {                                                 \
-        if (head != NULL)                             \
-            free_linked_list(head, addMcr, resNames); \
-        if (ip != NULL)                               \
-            fclose(ip);                               \
-        if (op != NULL)                               \
-            fclose(op);                               \
         if (ipName != NULL)                           \
             free(ipName);                             \
         if (opName != NULL)                           \
             free(opName);                             \
     } while (0);
 
-#define PP_CLOSE_AND_REMOVE_AM          \
-    do                                  \
-    {                                   \
-        remove(opName);                 \
-        PP_CLOSE(head, FALSE, resNames) \
+#define PP_FILES_CLOSE_AND_REMOVE_AM                  \
+    do                                                \
+    {                                                 \
+        if (opName != NULL)                           \
+            remove(opName);                           \
+        PP_FILES_CLOSE                                \
     } while (0);
 
 /* ___Enums___ */
 enum mcrDefFlag
 {
     OUTSIDE_MCR,
-    COUNTING_MCR_LINES,
-    ADDING_MCR_LINES
+    INSIDE_MCR
 };
 
 enum ppErrIndex
@@ -45,35 +50,39 @@ enum ppErrIndex
     PP_ERR_MCR_NAME_RES,     /* detected an attempt to name a macro with a reserved name */
     PP_ERR_INVALID_MCR_NAME, /* Invalid macro name */
     PP_ERR_MCR_ADD,          /* Error adding macro to list */
-    PP_ERR_EXTRA_ENDMCR_TEXT /* Extra text after "endmcr" command */
+    PP_ERR_EXTRA_ENDMCR_TEXT, /* Extra text after "endmcr" command */
+    PP_ERR_MISSING_ENDMCR,   /* The source ended inside a macro definition */
+    PP_ERR_END
 };
 
-/*___Error list___ */
-const char *ppErrList[] =
-    {
-        "The line is longer than 80 characters",
-        "Missing macro name after 'mcr' command",
-        "Detected extranous characters following the macro's name",
-        "The following macro's name is longer than 31 characters",
-        "The following macro's name is conflicting with a reserved name",
-        "The following macro name is invalid",
-        "Unsuccessful macro addition attempt for",
-        "Detected extranous characters following the 'endmcr' command"};
+/* ___Constants___ */
+extern const char *ppErrList[];
 
 /* ___Typedef___ */
-typedef struct mcrNode
+typedef struct mcrEntry
+{
+    int mcrName; /* id in the string pool */
+    lineBuffer body; /* the macro's lines, packed one after the other */
+} mcrEntry;
+
+typedef struct mcrTable
 {
-    char mcrName[MAX_LABEL_LENGTH + 1];
-    char (*lines)[MAX_LINE_LENGTH + 1];
-    int lineCount;
-    struct mcrNode *next;
-} mcrNode;
+    mcrEntry *entries; /* in definition order */
+    int count;
+    int capacity;
+    int *slots; /* open addressing index of entries, keyed by name id */
+    int slotCount;
+    stringPool *names; /* the pool the macros' names are interned in */
+} mcrTable;
 
 /* ___Prototypes___*/
-int is_long_line(ERR_DETAILS_SIG, char *lineToCheck, int buffer, FILE *ip);
-int valid_mcr(ERR_DETAILS_SIG, char *toCheck, char *resNames);
-mcrNode *new_mcr(const char *stage, char *name, mcrNode *next);
-int print_if_mcr(mcrNode *head, char *toCheck, FILE *op);
-void free_linked_list(mcrNode *head, int saveMcrNames, char *resNames);
+int expand_macros(diagList *diags, char *ipName, sourceFile *ip, resNamesIndex *resNames, stringPool *names, lineBuffer *amLines);
+int is_long_line(ERR_DETAILS_SIG, lineSlice *line);
+int valid_mcr(ERR_DETAILS_SIG, char *toCheck, resNamesIndex *resNames);
+int mcr_slot(mcrTable *mcrs, int name);
+mcrEntry *new_mcr(const errStage *stage, char *name, mcrTable *mcrs);
+int print_if_mcr(mcrTable *mcrs, char *toCheck, lineBuffer *amLines);
+int write_am(const errStage *stage, char *opName, lineBuffer *amLines, outputBuffer kept[]);
+void free_mcr_table(mcrTable *mcrs, int saveMcrNames, resNamesIndex *resNames);
 
 #endif
@@ -1,282 +1,525 @@
 #include "second_pass.h"
 
 /* ___The second pass___ */
-/* Returns:
+/* The output files that were written are added to outputs, as outputFile flags, and the errors are kept in diags (or printed if it is NULL).
+   The contents of the files written are kept in kept, and the files are counted in io, unless they are NULL.
+   Returns:
    - 0 (SUCCESS): The second pass was complete with no errors.
    - -1 (QUIT_UPON_ERROR) : An error occurred throughout the program, and no output files wew made.
 */
-int second_pass(char *baseName, char *resNames, short int codeImage[], short int *dataImage,
-                Opcodes ocList[], Directives dirList[], symbolNode **symbolHead, needLabelNode **needLHead, int makeOutput, int IC)
+int second_pass(diagList *diags, char *baseName, resNamesIndex *resNames, short int codeImage[], dataBuffer *data,
+                Opcodes ocList[], Directives dirList[], symbolTable *symbols, fixupTable *fixups, int makeOutput, int binaryOb, int IC, int *outputs, outputBuffer kept[], ioCounts *io)
 {
 
     /* ___Declarations___ */
 
-    /* symbols have been stored in a linked list */
-    symbolNode *head = *symbolHead,
-               *tempNode;
+    /* the extern references and the entries, in the order of the output files */
+    symbolRefList exts = {NULL, 0, 0},
+                  ents = {NULL, 0, 0};
 
-    needLabelNode *nlHead = *needLHead,
-                  *current;
+    /* the output files are staged in memory, and only written if the file had no errors */
+    outputBuffer obOut = {NULL, 0, 0},
+                 extOut = {NULL, 0, 0},
+                 entOut = {NULL, 0, 0};
 
-    FILE *ip = NULL,
-         *ob = NULL,
-         *ext = NULL,
-         *ent = NULL;
-         
     char *ipName = NULL,
          *obName = NULL,
          *extName = NULL,
          *entName = NULL,
-         *baseNamePrint = NULL;
+         *staleName = NULL; /* the other kind of object file, which an earlier build may have left */
 
-    int myDc = 0,
-        i = 0,
-        foundErrorFlag = (!makeOutput),
-        extFlag = FALSE,
-        entFlag = FALSE;
+    errStage spStage;
+    const errStage *stage = &spStage;
 
-    short int value = 0;
+    spStage.name = "second pass";
+    spStage.diags = diags;
+    spStage.io = io;
 
-    const char *stage = "second pass";
-
-    /* ___Adding the .am extension to the file's name___ */
+    /* ___Adding the .am extension to the file's name, for diagnostics___ */
     if ((ipName = add_ext(baseName, ".am")) == NULL)
     {
         err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
         return QUIT_UPON_ERROR;
     }
 
-    /* ___Opening the file___ */
-    if ((ip = fopen(ipName, "r")) == NULL)
+    /* ___Putting the labels' addresses in the code image___ */
+    /* the labels are resolved even if there were errors before, to report the missing ones as well */
+    if (resolve_labels(diags, ipName, codeImage, symbols, fixups, &exts) != SUCCESS || !makeOutput)
     {
-        err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], NULL);
         SP_CLOSE
         return QUIT_UPON_ERROR;
     }
 
-    /* going over the linked list "need label" */
-
-    /* the extern file will be created simultaniously, and deleted if an error was detected */
-    if ((extName = add_ext(baseName, ".ext")) == NULL)
+    /* ___Staging the extern file and the entry file (or the symbol sections of the .obj file)___ */
+    if (collect_entries(symbols, &ents) == FUNC_ERROR ||
+        write_symbols(&exts, &extOut, binaryOb) == FUNC_ERROR ||
+        write_symbols(&ents, &entOut, binaryOb) == FUNC_ERROR)
     {
         err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
         SP_CLOSE
         return QUIT_UPON_ERROR;
     }
-    if ((ext = fopen(extName, "w")) == NULL)
-    {
-        err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], NULL);
-        SP_CLOSE
-        return QUIT_UPON_ERROR;
-    }
 
-    /* for every node, we search for the label needed in the symbolNode list */
-    /* If we find it, we put its value (address) in the codeImage array in its binary form */
-    current = nlHead;
-    while (current != NULL)
+    /* ___The binary object file, which carries the entry and extern sections___ */
+    if (binaryOb)
     {
-        tempNode = is_symbol(head, current->labelName);
-        if (tempNode == NULL)
-        {
-            err_with_line(stage, current->readInLine, ipName, spErrList[SP_ERR_LABEL_NOT_FOUND], current->labelName);
-            foundErrorFlag = TRUE;
-        }
-        else if (tempNode->type == symbolType_extern)
+        if (write_obj(codeImage, IC, data, &entOut, ents.count, &extOut, exts.count, &obOut) == FUNC_ERROR ||
+            (obName = add_ext(baseName, ".obj")) == NULL ||
+            (staleName = add_ext(baseName, ".ob")) == NULL ||
+            (extName = add_ext(baseName, ".ext")) == NULL ||
+            (entName = add_ext(baseName, ".ent")) == NULL)
         {
-            /* for externs, the value is always 0 + its A, R, E value (always E)*/
-            value |= tempNode->ARE;
-            codeImage[current->IC] = value;
-
-            /* writing the extern value to the .ext file */
-            extFlag = TRUE;
-            fprintf(ext, "%s\t%04d\n", current->labelName, current->IC);
-            
+            err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+            SP_CLOSE
+            return QUIT_UPON_ERROR;
         }
-        else if (tempNode->type != symbolType_mdefine)
+        if (write_output(stage, obName, &obOut) == FUNC_ERROR)
         {
-            /* building the label's binary code */
-            value |= tempNode->value << LABEL_ADD_MOVE;
-            value |= tempNode->ARE;
-
-            codeImage[current->IC] = value;
+            SP_CLOSE
+            return QUIT_UPON_ERROR;
         }
+        *outputs |= OUTPUT_OBJ;
+        keep_output(kept, OUTPUT_OBJ, &obOut);
 
-        /* preparing for the next iteration */
-        value = 0;
-        current = current->next;
-    }
-
-    /* removing the .ext file if there was an error, or if there was no extern value */
-    if (foundErrorFlag || !extFlag)
-    {
+        /* the text output files of an earlier build are removed, so that they are not read instead of the .obj file */
+        remove(staleName);
         remove(extName);
+        remove(entName);
+
+        SP_CLOSE
+        return SUCCESS;
     }
 
-    /* proceeding only if there were no errors found */
-    if (foundErrorFlag)
+    /* ___Staging the object file___ */
+    if (write_ob(codeImage, IC, data, &obOut) == FUNC_ERROR)
     {
+        err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
         SP_CLOSE
         return QUIT_UPON_ERROR;
     }
 
     /* making strings representing the names of the output files */
-    /* object */
-    if ((obName = add_ext(baseName, ".ob")) == NULL)
+    if ((obName = add_ext(baseName, ".ob")) == NULL ||
+        (extName = add_ext(baseName, ".ext")) == NULL ||
+        (entName = add_ext(baseName, ".ent")) == NULL ||
+        (staleName = add_ext(baseName, ".obj")) == NULL)
     {
         err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
         SP_CLOSE
         return QUIT_UPON_ERROR;
     }
-    /* entry */
-    if ((entName = add_ext(baseName, ".ent")) == NULL)
+
+    /* ___Writing the files___ */
+    /* the .ext and .ent files are only made if they are not empty, and a file that could not be written takes the files written before it along */
+    if (write_output(stage, obName, &obOut) == FUNC_ERROR)
     {
-        err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
         SP_CLOSE
         return QUIT_UPON_ERROR;
     }
-
-    /* ___Opening the files___ */
-    /* object */
-    if ((ob = fopen(obName, "w")) == NULL)
+    if (exts.count > 0 && write_output(stage, extName, &extOut) == FUNC_ERROR)
     {
-        err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], NULL);
+        remove(obName);
         SP_CLOSE
         return QUIT_UPON_ERROR;
     }
-    /* entry */
-    if ((ent = fopen(entName, "w")) == NULL)
+    if (ents.count > 0 && write_output(stage, entName, &entOut) == FUNC_ERROR)
     {
-        err_wo_line(stage, generalErrList[GEN_ERR_FOPEN], NULL);
+        remove(obName);
+        if (exts.count > 0)
+            remove(extName);
         SP_CLOSE
         return QUIT_UPON_ERROR;
     }
 
-    /* ___Making the object file___ */
-    while (dataImage[myDc] < PLACEHOLDER)
+    /* a file that is not made is removed, so that none is left from an earlier build of the source - a .obj file of a -bin build as well */
+    remove(staleName);
+    *outputs |= OUTPUT_OB;
+    keep_output(kept, OUTPUT_OB, &obOut);
+    if (exts.count > 0)
     {
-        myDc++; /* counting the amount of data words */
+        *outputs |= OUTPUT_EXT;
+        keep_output(kept, OUTPUT_EXT, &extOut);
     }
+    else
+        remove(extName);
+    if (ents.count > 0)
+    {
+        *outputs |= OUTPUT_ENT;
+        keep_output(kept, OUTPUT_ENT, &entOut);
+    }
+    else
+        remove(entName);
+    
+    SP_CLOSE
+    return SUCCESS;
+}
 
-    /* printing the .ob header */
-    fprintf(ob, "  %d %d\n", IC, myDc);
+/* Removes the output files of a source whose build failed, so that the files of an earlier build are not read as its output.
+   Parameters:
+   - stage: The stage of the program, for diagnostics.
+   - baseName: The source's name, without an extension.
+
+   Notes:
+   - The .am file is left to the pre-processor, which keeps it for a source whose macros were expanded.
+*/
+void remove_outputs(const errStage *stage, char *baseName)
+{
+    char *exts[OBJECT_OUTPUTS] = {".ob", ".obj", ".ext", ".ent"},
+         *name;
 
-    /* printing the instructions section to the .ob file */
-    for (i = IMAGE_OFFSET; i < (IC + IMAGE_OFFSET); i++)
+    int index;
+
+    for (index = 0; index < OBJECT_OUTPUTS; index++)
     {
-        fprintf(ob, "%04d ", i);
-        print_encoded_4(codeImage[i], ob);
+        if ((name = add_ext(baseName, exts[index])) == NULL)
+        {
+            err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+            return;
+        }
+        remove(name);
+        free(name);
     }
+}
+
+/* Puts the labels' addresses in the code image, with no access to files.
+   Parameters:
+   - diags: Where the errors are kept, or NULL to print them.
+   - ipName: The name of the source, for diagnostics.
+   - codeImage: The code image.
+   - symbols: The symbol table.
+   - fixups: The code image cells that need labels.
+   - exts: The list the extern references are added to, in the order of the code image.
+
+   Returns:
+   - 0 (SUCCESS) if every label was found.
+   - -1 (QUIT_UPON_ERROR) if a label was not found (all of them are reported), or there was an error during memory allocation.
+*/
+int resolve_labels(diagList *diags, char *ipName, short int codeImage[], symbolTable *symbols, fixupTable *fixups, symbolRefList *exts)
+{
+    /* symbols have been stored in a hashed symbol table */
+    symbolEntry *tempNode;
+
+    /* the code image cells that need labels have been stored in a fixup table */
+    fixup *current;
+
+    int i,
+        foundErrorFlag = FALSE;
 
-    /* printing the data section to the .ob file */
-    i = 0;
-    while (dataImage[i] < PLACEHOLDER)
+    errStage spStage;
+    const errStage *stage = &spStage;
+
+    spStage.name = "second pass";
+    spStage.diags = diags;
+    spStage.io = NULL;
+
+    /* every fixup holds its label's entry in the symbol table */
+    /* If the label was defined, we put its value (address) in the codeImage array in its binary form */
+    for (i = 0; i < fixups->count && !DIAG_LIMIT_REACHED(diags); i++)
     {
-        fprintf(ob, "%04d ", (i + IC + IMAGE_OFFSET));
-        print_encoded_4(dataImage[i], ob);
-        i++;
+        current = &fixups->items[i];
+        tempNode = &symbols->entries[current->symbol];
+
+        if (tempNode->type == symbolType_pending)
+        {
+            err_with_line(stage, current->readInLine, ipName, spErrList[SP_ERR_LABEL_NOT_FOUND], POOL_STR(symbols->names, tempNode->name));
+            foundErrorFlag = TRUE;
+        }
+        else if (tempNode->type == symbolType_extern)
+        {
+            /* for externs, the value is always 0 + its A, R, E value (always E)*/
+            codeImage[current->IC] = tempNode->ARE;
+
+            if (add_symbol_ref(exts, POOL_STR(symbols->names, tempNode->name), current->IC) == FUNC_ERROR)
+            {
+                err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+                return QUIT_UPON_ERROR;
+            }
+        }
+        else if (tempNode->type != symbolType_mdefine)
+        {
+            /* building the label's binary code */
+            codeImage[current->IC] = (tempNode->value << LABEL_ADD_MOVE) | tempNode->ARE;
+        }
     }
-    if (strrchr(baseName, '/') != NULL)
-    {   /* the base name is a file path */
-        /* we will only print the file's name */
-        baseName = strrchr(baseName, '/') + 1;
+
+    /* the labels are not all resolved if the errors reached their limit */
+    return (foundErrorFlag || DIAG_LIMIT_REACHED(diags)) ? QUIT_UPON_ERROR : SUCCESS;
+}
+
+/* Lists the entry symbols, in their definition order.
+   Parameters:
+   - symbols: The symbol table.
+   - ents: The list the entries are added to.
+
+   Returns:
+   - 1 (TRUE) if the entries were listed.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int collect_entries(symbolTable *symbols, symbolRefList *ents)
+{
+    int index;
+
+    for (index = 0; index < symbols->defCount; index++)
+    {
+        symbolEntry *current = &symbols->entries[symbols->defOrder[index]];
+
+        if (current->type == symbolType_entry &&
+            add_symbol_ref(ents, POOL_STR(symbols->names, current->name), current->value) == FUNC_ERROR)
+            return FUNC_ERROR;
     }
-    printf(">>> An Object file (.ob) was added to the directory.\n");
+    return TRUE;
+}
 
-    /* ___Making the .ent file___ */
-    entFlag = write_ent(head, ent);
+/* Adds a label's address to a list of entries or extern references.
+   Parameters:
+   - refs: The list.
+   - name: The label's name, which must outlive the list.
+   - address: The address.
 
-    /* ___Removing the empty files____ */
-    if (!extFlag)
-        remove(extName);
-    else
-        printf(">>> An Extern file (.ext) was added to the directory.\n");
-  
-    if (!entFlag)
-        remove(entName);
-    else
-        printf(">>> An Entry file (.ent) was added to the directory.\n");
-    
-    SP_CLOSE
-    return SUCCESS;
+   Returns:
+   - 1 (TRUE) if it was added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int add_symbol_ref(symbolRefList *refs, const char *name, int address)
+{
+    if (refs->count == refs->capacity)
+    {
+        int newCapacity = (refs->capacity == 0) ? SYMBOL_REFS_INIT_SIZE : refs->capacity * 2;
+
+        symbolRef *temp = (symbolRef *)realloc(refs->items, newCapacity * sizeof(symbolRef));
+        if (temp == NULL)
+            return FUNC_ERROR;
+
+        refs->items = temp;
+        refs->capacity = newCapacity;
+    }
+
+    refs->items[refs->count].name = name;
+    refs->items[refs->count].address = address;
+    refs->count++;
+    return TRUE;
+}
+
+/* Frees the memory allocated for a list of entries or extern references, leaving it empty.
+   Parameters:
+   - refs: The list.
+*/
+void free_symbol_refs(symbolRefList *refs)
+{
+    free(refs->items);
+
+    refs->items = NULL;
+    refs->count = refs->capacity = 0;
 }
 
 /* ___Helper functions____ */
 
-/* Prints the encoded representation of a 14-bit long memory word using a custom 4-base encoding scheme.
+/* Encodes a 14-bit long memory word using a custom 4-base encoding scheme.
    Parameters:
-   - toPrint: The short integer to be encoded and printed.
-   - ob: Pointer to the FILE object where the encoded representation will be printed.
+   - word: The memory word to encode.
+   - out: Where the WORD_SYMBOLS symbols will be written (not null terminated).
 
    Explanation:
-   This function takes a short integer and prints its encoded representation using a custom 4-base encoding scheme.
-   Each 2 bits of the input integer are represented by one of four symbols: '*', '#', '%', or '!'.
-   The encoded symbols are printed to the specified file object 'ob'.
+   Each 2 bits of the word are represented by one of four symbols: '*', '#', '%', or '!' (00, 01, 10, 11).
+   The symbols of every byte are generated ahead of time, so the word is put together from the 3 symbols
+   of its 6 leftmost bits, and the 4 symbols of its rightmost byte.
+*/
+void encode_word_4(short int word, char *out)
+{
+    memcpy(out, encodedByte[(word >> 8) & 0x3F] + 1, WORD_SYMBOLS - BYTE_SYMBOLS);
+    memcpy(out + WORD_SYMBOLS - BYTE_SYMBOLS, encodedByte[word & 0xFF], BYTE_SYMBOLS);
+}
 
-   For example:
-   - Binary 00 is represented as '*'.
-   - Binary 01 is represented as '#'.
-   - Binary 10 is represented as '%'.
-   - Binary 11 is represented as '!'.
+/* Writes a zero padded decimal address of at least ADDRESS_WIDTH digits.
+   Parameters:
+   - address: The address (not negative).
+   - out: Where the digits will be written (not null terminated).
 
-   The function processes the input integer bitwise, printing the encoded symbols one by one from right to left to the .ob file.
+   Returns:
+   - The number of digits written.
 */
-void print_encoded_4(short int toPrint, FILE *ob)
+int format_address(int address, char *out)
 {
-    int res,
+    char digits[MAX_ADDRESS_DIGITS];
+    int len = 0,
         index;
 
-    char code[WORD_LENGTH_4_ENCODED + 1] = "";
+    do
+    {
+        digits[len++] = '0' + address % 10;
+        address /= 10;
+    } while (address > 0);
+
+    while (len < ADDRESS_WIDTH)
+        digits[len++] = '0';
+
+    for (index = 0; index < len; index++)
+        out[index] = digits[len - 1 - index];
+
+    return len;
+}
+
+/* Formats the object file into an output buffer - its header, then a line for every word of the code image and the data image.
+   Parameters:
+   - codeImage: The code image.
+   - IC: The number of words in the code image.
+   - data: The data image.
+   - ob: The output buffer of the .ob file.
 
-    for (index = WORD_LENGTH_4_ENCODED - 1; index >= 0; index--)
+   Returns:
+   - 1 (TRUE) if the file was formatted.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+
+   Notes:
+   - The buffer is reserved once, for the longest possible lines.
+*/
+int write_ob(short int codeImage[], int IC, dataBuffer *data, outputBuffer *ob)
+{
+    int index;
+
+    if (reserve_output(ob, (IC + data->count) * OB_LINE_MAX_LENGTH + OB_HEADER_MAX_LENGTH) == FUNC_ERROR)
+        return FUNC_ERROR;
+
+    /* the header */
+    ob->size += sprintf(ob->chars + ob->size, "  %d %d\n", IC, data->count);
+
+    /* the instructions section, followed by the data section */
+    for (index = 0; index < IC + data->count; index++)
     {
-        /* proccessing every 2 rightmost bits at a time */
-        res = MASK & toPrint;
-        switch (res)
-        {
-        case 0:
-        {
-            code[index] = '*';
-            break;
-        }
-        case 1:
-        {
-            code[index] = '#';
-            break;
-        }
-        case 2:
-        {
-            code[index] = '%';
-            break;
-        }
-        case 3:
-        {
-            code[index] = '!';
-            break;
-        }
-        default:
-            break;
-        }
-        /* discard the printed bits and move to the next two */
-        toPrint = toPrint >> AFTER_PRINT_MOVE;
+        ob->size += format_address(index + IMAGE_OFFSET, ob->chars + ob->size);
+        ob->chars[ob->size++] = ' ';
+
+        encode_word_4((index < IC) ? codeImage[index + IMAGE_OFFSET] : data->words[index - IC], ob->chars + ob->size);
+        ob->size += WORD_SYMBOLS;
+        ob->chars[ob->size++] = '\n';
     }
-    fprintf(ob, "%s\n", code);
+    return TRUE;
 }
 
-int write_ent(symbolNode *head, FILE *ent)
+/* Formats a list of entries or extern references into the output buffer of the .ent or .ext file (or a symbol section of the .obj file).
+   Parameters:
+   - refs: The list.
+   - out: The output buffer (left empty if the list is).
+   - binary: Whether the symbols are formatted as binary records.
+
+   Returns:
+   - 1 (TRUE) if the symbols were formatted.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int write_symbols(symbolRefList *refs, outputBuffer *out, int binary)
+{
+    int index;
+
+    for (index = 0; index < refs->count; index++)
+    {
+        if (add_symbol_record(out, refs->items[index].name, refs->items[index].address, binary) == FUNC_ERROR)
+            return FUNC_ERROR;
+    }
+    return TRUE;
+}
+
+/* Appends a symbol's record to an output buffer:
+   - As a line of the .ext or .ent file - the symbol's name, a tab, and the address.
+   - As a binary record of the .obj file - the address, the name's length (a single byte), and the name.
+   Parameters:
+   - out: The output buffer.
+   - name: The symbol's name.
+   - address: The address.
+   - binary: Whether the record is binary.
+
+   Returns:
+   - 1 (TRUE) if the record was added.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int add_symbol_record(outputBuffer *out, const char *name, int address, int binary)
 {
-    symbolNode *current = head;
+    int len = strlen(name);
 
-    int entFlag = FALSE;
+    if (reserve_output(out, len + MAX_ADDRESS_DIGITS + 2) == FUNC_ERROR)
+        return FUNC_ERROR;
 
-    while (current != NULL)
+    if (binary)
     {
-        if (current->type == symbolType_entry)
-        {
-            entFlag = TRUE;
-            fprintf(ent, "%s\t%04d\n", current->symbolName, current->value);
-        }
-        current = current->next;
+        put_obj_field(out->chars + out->size, address);
+        out->size += OBJ_FIELD_SIZE;
+        out->chars[out->size++] = (char)len;
+        memcpy(out->chars + out->size, name, len);
+        out->size += len;
+        return TRUE;
     }
-    return entFlag;
+
+    memcpy(out->chars + out->size, name, len);
+    out->size += len;
+    out->chars[out->size++] = '\t';
+    out->size += format_address(address, out->chars + out->size);
+    out->chars[out->size++] = '\n';
+
+    return TRUE;
+}
+
+/* Writes a 16-bit field of the .obj file, low byte first.
+   Parameters:
+   - out: Where the OBJ_FIELD_SIZE bytes will be written.
+   - value: The value of the field.
+*/
+void put_obj_field(char *out, int value)
+{
+    out[0] = (char)(value & 0xFF);
+    out[1] = (char)((value >> 8) & 0xFF);
 }
 
+/* Formats the binary object file into an output buffer - its header, the words of the code image and the data image,
+   then the entry and extern sections.
+   Parameters:
+   - codeImage: The code image.
+   - IC: The number of words in the code image.
+   - data: The data image.
+   - ent, entCount: The entry records, and their number.
+   - ext, extCount: The extern records, and their number.
+   - obj: The output buffer of the .obj file.
+
+   Returns:
+   - 1 (TRUE) if the file was formatted.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int write_obj(short int codeImage[], int IC, dataBuffer *data, outputBuffer *ent, int entCount,
+              outputBuffer *ext, int extCount, outputBuffer *obj)
+{
+    int index;
+
+    if (reserve_output(obj, OBJ_HEADER_LENGTH + (IC + data->count) * OBJ_FIELD_SIZE + ent->size + ext->size) == FUNC_ERROR)
+        return FUNC_ERROR;
+
+    /* the header */
+    memcpy(obj->chars, OBJ_MAGIC, OBJ_MAGIC_LENGTH);
+    obj->size = OBJ_MAGIC_LENGTH;
+    put_obj_field(obj->chars + obj->size, IMAGE_OFFSET);
+    put_obj_field(obj->chars + obj->size + OBJ_FIELD_SIZE, IC);
+    put_obj_field(obj->chars + obj->size + 2 * OBJ_FIELD_SIZE, data->count);
+    put_obj_field(obj->chars + obj->size + 3 * OBJ_FIELD_SIZE, entCount);
+    put_obj_field(obj->chars + obj->size + 4 * OBJ_FIELD_SIZE, extCount);
+    obj->size += OBJ_HEADER_FIELDS * OBJ_FIELD_SIZE;
+
+    /* the instructions section, followed by the data section */
+    for (index = 0; index < IC + data->count; index++)
+    {
+        put_obj_field(obj->chars + obj->size, ((index < IC) ? codeImage[index + IMAGE_OFFSET] : data->words[index - IC]) & WORD_MASK);
+        obj->size += OBJ_FIELD_SIZE;
+    }
+
+    /* the symbol sections */
+    if (ent->size > 0)
+        memcpy(obj->chars + obj->size, ent->chars, ent->size);
+    obj->size += ent->size;
+    if (ext->size > 0)
+        memcpy(obj->chars + obj->size, ext->chars, ext->size);
+    obj->size += ext->size;
+
+    return TRUE;
+}
+
+/*___Error list___ */
+const char *spErrList[] =
+{
+	"The following label could not be found"
+};
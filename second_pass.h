@@ -4,43 +4,38 @@
 
 /* ___Include___ */
 #include "general_lib.h"
+#include "op_tables.h"
 
 /* ___Define___ */
 #define MAX_OPERANDS 2
 #define MAX_EMPTY_CELLS 5
-#define WORD_LENGTH_4_ENCODED 7 
-
-#define LABEL_ADD_MOVE 2
-#define AFTER_PRINT_MOVE 2
-#define MASK 0x0003
+#define ADDRESS_WIDTH 4
+#define MAX_ADDRESS_DIGITS 10
+#define OB_LINE_MAX_LENGTH (MAX_ADDRESS_DIGITS + WORD_SYMBOLS + 2) /* address, space, word, newline */
+#define OB_HEADER_MAX_LENGTH (2 * MAX_ADDRESS_DIGITS + 5)			 /* 2 spaces, IC, space, DC, newline, null terminator */
+#define OBJECT_OUTPUTS 4											 /* .ob, .obj, .ext and .ent */
 
 /* ___Macros___ */
-#define SP_CLOSE                   \
-	do                             \
-	{                              \
-		if (ob != NULL)            \
-			fclose(ob);            \
-		if (obName != NULL)        \
-			free(obName);          \
-                                   \
-		if (ext != NULL)           \
-			fclose(ext);           \
-		if (extName != NULL)       \
-			free(extName);         \
-                                   \
-		if (ent != NULL)           \
-			fclose(ent);           \
-		if (entName != NULL)       \
-			free(entName);         \
-                                   \
-		if (ip != NULL)            \
-			fclose(ip);            \
-		if (ipName != NULL)        \
-			free(ipName);          \
-                                   \
-		if (baseNamePrint != NULL) \
-			free(baseNamePrint);   \
-                                   \
+#define SP_CLOSE                     \
+	do                               \
+	{                                \
+		free_output_buffer(&obOut);  \
+		free_output_buffer(&extOut); \
+		free_output_buffer(&entOut); \
+		free_symbol_refs(&exts);     \
+		free_symbol_refs(&ents);     \
+                                     \
+		if (obName != NULL)          \
+			free(obName);            \
+		if (extName != NULL)         \
+			free(extName);           \
+		if (entName != NULL)         \
+			free(entName);           \
+		if (staleName != NULL)       \
+			free(staleName);         \
+                                     \
+		if (ipName != NULL)          \
+			free(ipName);            \
 	} while (0);
 
 /* ___Enums___ */
@@ -48,18 +43,26 @@
 /* prefix 'SP' indicates second pass context */
 enum spErrIndex
 {
-	SP_ERR_LABEL_NOT_FOUND /* Could not find an expected label in the symbol list */
+	SP_ERR_LABEL_NOT_FOUND, /* Could not find an expected label in the symbol list */
+	SP_ERR_END
 };
 
 /* ___Constants___ */
-const char *spErrList[] =
-{
-	"The following label could not be found"
-};
+extern const char *spErrList[];
 
 /* ___Prototypes___*/
-void print_encoded_4(short int toPrint, FILE *ob);
-int write_ent(symbolNode *head, FILE *ent);
-int calc_L_for_operands(ERR_DETAILS_SIG, int destAddRess, int srcAddRess, symbolNode *head, char *resNames);
+int resolve_labels(diagList *diags, char *ipName, short int codeImage[], symbolTable *symbols, fixupTable *fixups, symbolRefList *exts);
+int collect_entries(symbolTable *symbols, symbolRefList *ents);
+int add_symbol_ref(symbolRefList *refs, const char *name, int address);
+void free_symbol_refs(symbolRefList *refs);
+void encode_word_4(short int word, char *out);
+int format_address(int address, char *out);
+int write_ob(short int codeImage[], int IC, dataBuffer *data, outputBuffer *ob);
+int write_symbols(symbolRefList *refs, outputBuffer *out, int binary);
+int add_symbol_record(outputBuffer *out, const char *name, int address, int binary);
+void put_obj_field(char *out, int value);
+int write_obj(short int codeImage[], int IC, dataBuffer *data, outputBuffer *ent, int entCount,
+              outputBuffer *ext, int extCount, outputBuffer *obj);
+int calc_L_for_operands(ERR_DETAILS_SIG, int destAddRess, int srcAddRess, symbolTable *symbols, resNamesIndex *resNames);
 
 #endif
@@ -0,0 +1,598 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "server.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+
+/* ___The server___ */
+/* The server stays resident, with its tables built once, and hands requests to preforked workers over a Unix domain socket.
+   A request is a command line - the number of arguments in text, then every argument followed by a null terminator.
+   The client's standard streams and working directory are passed along with it, so the request is handled as if it was run
+   by the client - everything is printed to the client's terminal, and files are relative to the client's directory.
+   The reply is the request's exit status, in text. */
+
+/* Opens a Unix domain socket.
+   Parameters:
+   - socketName: The socket's path.
+   - listening: Whether to listen on the socket (for the server), or to connect to it (for the client).
+
+   Returns:
+   - The socket's file descriptor.
+   - -1 (FUNC_ERROR) if the socket could not be opened.
+
+   Notes:
+   - A socket that was left behind by a server that did not stop is replaced, other files are not.
+*/
+int open_socket(const char *socketName, int listening)
+{
+	struct sockaddr_un address;
+	struct stat info;
+	int fd;
+
+	if (strlen(socketName) >= sizeof(address.sun_path))
+		return FUNC_ERROR;
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketName);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		return FUNC_ERROR;
+
+	if (listening)
+	{
+		if (stat(socketName, &info) == 0 && S_ISSOCK(info.st_mode))
+			unlink(socketName);
+
+		if (bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0 && listen(fd, LISTEN_BACKLOG) == 0)
+			return fd;
+	}
+	else if (connect(fd, (struct sockaddr *)&address, sizeof(address)) == 0)
+		return fd;
+
+	close(fd);
+	return FUNC_ERROR;
+}
+
+/* Serves requests until the server is stopped (with SIGINT or SIGTERM).
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - socketName: The socket's path.
+   - workers: The number of workers (at most MAX_SERVER_WORKERS), each handling one request at a time.
+   - handle: The function that handles a request, in a worker.
+   - context: Passed on to handle.
+
+   Returns:
+   - 0 (SUCCESS) once the server was stopped.
+   - -1 (QUIT_UPON_ERROR) if the socket could not be opened, or no worker could be started.
+
+   Notes:
+   - A worker that stopped is replaced, so a request that crashed a worker does not take the server down.
+*/
+int serve_requests(const errStage *stage, const char *socketName, int workers, requestHandler handle, void *context)
+{
+	long pids[MAX_SERVER_WORKERS];
+
+	sigset_t signals,
+		previous;
+
+	int listenFd,
+		index,
+		sig,
+		status,
+		started = 0;
+
+	pid_t pid;
+
+	if (workers > MAX_SERVER_WORKERS)
+		workers = MAX_SERVER_WORKERS;
+
+	if ((listenFd = open_socket(socketName, TRUE)) < 0)
+	{
+		err_wo_line(stage, srvErrList[SRV_ERR_SOCKET], (char *)socketName);
+		return QUIT_UPON_ERROR;
+	}
+
+	/* the signals are waited for, instead of interrupting the server */
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGCHLD);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigprocmask(SIG_BLOCK, &signals, &previous);
+
+	/* ___Starting the workers___ */
+	for (index = 0; index < workers; index++)
+	{
+		if ((pids[index] = start_server_worker(stage, listenFd, handle, context)) > 0)
+			started++;
+	}
+
+	if (started > 0)
+	{
+		printf(">>> Serving requests on \"%s\", with %d workers.\n", socketName, started);
+		fflush(stdout);
+	}
+
+	/* ___Replacing the workers that stopped, until the server is stopped___ */
+	while (started > 0)
+	{
+		if (sigwait(&signals, &sig) != 0)
+			continue;
+
+		if (sig != SIGCHLD)
+			break;
+
+		while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+		{
+			for (index = 0; index < workers; index++)
+			{
+				if (pids[index] == (long)pid)
+					pids[index] = start_server_worker(stage, listenFd, handle, context);
+			}
+		}
+	}
+
+	/* ___Stopping the workers___ */
+	for (index = 0; index < workers; index++)
+	{
+		if (pids[index] > 0)
+			kill((pid_t)pids[index], SIGTERM);
+	}
+	for (index = 0; index < workers; index++)
+	{
+		if (pids[index] > 0)
+			waitpid((pid_t)pids[index], &status, 0);
+	}
+
+	close(listenFd);
+	unlink(socketName);
+	sigprocmask(SIG_SETMASK, &previous, NULL);
+
+	return (started > 0) ? SUCCESS : QUIT_UPON_ERROR;
+}
+
+/* Starts a worker, which accepts requests and handles them one at a time.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - listenFd: The socket the requests are accepted from.
+   - handle: The function that handles a request.
+   - context: Passed on to handle.
+
+   Returns:
+   - The worker's process id.
+   - -1 (FUNC_ERROR) if the worker could not be started.
+*/
+long start_server_worker(const errStage *stage, int listenFd, requestHandler handle, void *context)
+{
+	sigset_t signals;
+
+	int conn;
+
+	pid_t pid;
+
+	/* anything still buffered would be printed by the worker as well */
+	fflush(stdout);
+	fflush(stderr);
+
+	if ((pid = fork()) < 0)
+	{
+		err_wo_line(stage, srvErrList[SRV_ERR_WORKER], NULL);
+		return FUNC_ERROR;
+	}
+	if (pid > 0)
+		return (long)pid;
+
+	/* ___The worker___ */
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGCHLD);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigprocmask(SIG_UNBLOCK, &signals, NULL);
+
+	/* a client that went away does not stop the worker */
+	signal(SIGPIPE, SIG_IGN);
+
+	while (TRUE)
+	{
+		if ((conn = accept(listenFd, NULL, NULL)) < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			err_wo_line(stage, srvErrList[SRV_ERR_SOCKET], NULL);
+			_exit(EXIT_FAILURE);
+		}
+
+		handle_request(stage, conn, handle, context);
+		close(conn);
+	}
+	return FUNC_ERROR;
+}
+
+/* Handles a single request, with the client's standard streams and working directory in place, and replies with its exit status.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - conn: The client's connection.
+   - handle: The function that handles the request.
+   - context: Passed on to handle.
+
+   Returns:
+   - 1 (TRUE) if the reply was sent.
+   - -1 (FUNC_ERROR) otherwise.
+
+   Notes:
+   - A request that is not valid is replied to with -1 (QUIT_UPON_ERROR), and is reported by the server.
+*/
+int handle_request(const errStage *stage, int conn, requestHandler handle, void *context)
+{
+	outputBuffer request = {NULL, 0, 0};
+
+	int fds[PASSED_FDS] = {-1, -1, -1, -1},
+		saved[PASSED_FDS] = {-1, -1, -1, -1},
+		argc,
+		index,
+		res = QUIT_UPON_ERROR;
+
+	char **argv = NULL,
+		 reply[REPLY_LENGTH];
+
+	if (receive_request(conn, fds, &request) == FUNC_ERROR || (argv = split_request(&request, &argc)) == NULL)
+		err_wo_line(stage, srvErrList[SRV_ERR_REQUEST], NULL);
+	else if (swap_streams(fds, saved) == FUNC_ERROR)
+		err_wo_line(stage, srvErrList[SRV_ERR_STREAMS], NULL);
+	else
+	{
+		res = handle(argc, argv, context);
+		restore_streams(saved);
+	}
+
+	for (index = 0; index < PASSED_FDS; index++)
+	{
+		if (fds[index] >= 0)
+			close(fds[index]);
+	}
+	free(argv);
+	free_output_buffer(&request);
+
+	sprintf(reply, "%d\n", res);
+	return (write(conn, reply, strlen(reply)) == (ssize_t)strlen(reply)) ? TRUE : FUNC_ERROR;
+}
+
+/* Receives a request, and the client's file descriptors that come along with it.
+   Parameters:
+   - conn: The client's connection.
+   - fds: Where the PASSED_FDS file descriptors are put.
+   - request: The buffer the request is read into, until the client stops writing.
+
+   Returns:
+   - 1 (TRUE) if the request was received.
+   - -1 (FUNC_ERROR) if it could not be read, it did not carry the file descriptors, or there was an error during memory allocation.
+*/
+int receive_request(int conn, int fds[], outputBuffer *request)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+
+	/* aligned for the control message */
+	union
+	{
+		struct cmsghdr header;
+		char chars[CMSG_SPACE(PASSED_FDS * sizeof(int))];
+	} control;
+
+	ssize_t len;
+
+	if (reserve_output(request, REQUEST_READ_SIZE) == FUNC_ERROR)
+		return FUNC_ERROR;
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = request->chars;
+	iov.iov_len = REQUEST_READ_SIZE;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.chars;
+	msg.msg_controllen = sizeof(control.chars);
+
+	while ((len = recvmsg(conn, &msg, 0)) < 0 && errno == EINTR)
+		;
+	if (len <= 0)
+		return FUNC_ERROR;
+	request->size = (int)len;
+
+	/* the file descriptors come along with the first part of the request */
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+		return FUNC_ERROR;
+
+	if (cmsg->cmsg_len == CMSG_LEN(PASSED_FDS * sizeof(int)))
+		memcpy(fds, CMSG_DATA(cmsg), PASSED_FDS * sizeof(int));
+
+	if ((msg.msg_flags & MSG_CTRUNC) || fds[PASSED_FDS - 1] < 0)
+		return FUNC_ERROR;
+
+	/* the rest of the request */
+	while (TRUE)
+	{
+		if (reserve_output(request, REQUEST_READ_SIZE) == FUNC_ERROR)
+			return FUNC_ERROR;
+
+		if ((len = read(conn, request->chars + request->size, REQUEST_READ_SIZE)) > 0)
+			request->size += (int)len;
+		else if (len == 0)
+			return TRUE;
+		else if (errno != EINTR)
+			return FUNC_ERROR;
+	}
+}
+
+/* Splits a request into a command line.
+   Parameters:
+   - request: The request - the number of arguments and a newline character, then every argument followed by a null terminator.
+   - argc: Where the number of arguments is put.
+
+   Returns:
+   - The arguments, pointing into the request, followed by NULL.
+   - NULL if the request is not valid, or there was an error during memory allocation.
+*/
+char **split_request(outputBuffer *request, int *argc)
+{
+	char **argv,
+		*next,
+		*end = request->chars + request->size;
+
+	int count,
+		index;
+
+	if ((next = (char *)memchr(request->chars, '\n', request->size)) == NULL || (count = atoi(request->chars)) < 1)
+		return NULL;
+	next++;
+
+	if ((argv = (char **)malloc((count + 1) * sizeof(char *))) == NULL)
+		return NULL;
+
+	for (index = 0; index < count; index++)
+	{
+		char *terminator;
+
+		if (next >= end || (terminator = (char *)memchr(next, '\0', end - next)) == NULL)
+		{
+			free(argv);
+			return NULL;
+		}
+		argv[index] = next;
+		next = terminator + 1;
+	}
+
+	if (next != end)
+	{
+		free(argv);
+		return NULL;
+	}
+
+	argv[count] = NULL;
+	*argc = count;
+	return argv;
+}
+
+/* Switches to the client's standard streams and working directory, keeping the server's own.
+   Parameters:
+   - fds: The client's standard input, output and error, and working directory.
+   - saved: Where the server's own are kept, for restore_streams.
+
+   Returns:
+   - 1 (TRUE) if the switch was made.
+   - -1 (FUNC_ERROR) if it could not be made - the server's own are left in place.
+*/
+int swap_streams(int fds[], int saved[])
+{
+	int index;
+
+	fflush(stdout);
+	fflush(stderr);
+
+	for (index = 0; index < PASSED_FDS - 1; index++)
+	{
+		if ((saved[index] = dup(index)) < 0)
+		{
+			restore_streams(saved);
+			return FUNC_ERROR;
+		}
+	}
+	if ((saved[PASSED_FDS - 1] = open(".", O_RDONLY)) < 0)
+	{
+		restore_streams(saved);
+		return FUNC_ERROR;
+	}
+
+	for (index = 0; index < PASSED_FDS - 1; index++)
+	{
+		if (dup2(fds[index], index) < 0)
+		{
+			restore_streams(saved);
+			return FUNC_ERROR;
+		}
+	}
+	if (fchdir(fds[PASSED_FDS - 1]) != 0)
+	{
+		restore_streams(saved);
+		return FUNC_ERROR;
+	}
+	return TRUE;
+}
+
+/* Switches back to the server's own standard streams and working directory.
+   Parameters:
+   - saved: The server's own, as kept by swap_streams (-1 for the ones that were not).
+*/
+void restore_streams(int saved[])
+{
+	int index;
+
+	fflush(stdout);
+	fflush(stderr);
+
+	for (index = 0; index < PASSED_FDS - 1; index++)
+	{
+		if (saved[index] >= 0)
+		{
+			dup2(saved[index], index);
+			close(saved[index]);
+			saved[index] = -1;
+		}
+	}
+	if (saved[PASSED_FDS - 1] >= 0)
+	{
+		fchdir(saved[PASSED_FDS - 1]);
+		close(saved[PASSED_FDS - 1]);
+		saved[PASSED_FDS - 1] = -1;
+	}
+}
+
+/* ___The client___ */
+
+/* Sends a command line to the server, along with the standard streams and the working directory, and waits for its exit status.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - socketName: The server's socket.
+   - argc, argv: The command line of the request, starting with the program's name.
+
+   Returns:
+   - The exit status of the request.
+   - -1 (QUIT_UPON_ERROR) if the server could not be reached, or did not reply.
+*/
+int run_client(const errStage *stage, const char *socketName, int argc, char *argv[])
+{
+	outputBuffer request = {NULL, 0, 0};
+
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+
+	/* aligned for the control message */
+	union
+	{
+		struct cmsghdr header;
+		char chars[CMSG_SPACE(PASSED_FDS * sizeof(int))];
+	} control;
+
+	int fds[PASSED_FDS],
+		conn,
+		index,
+		len,
+		sent,
+		res = QUIT_UPON_ERROR;
+
+	char reply[REPLY_LENGTH];
+
+	ssize_t written;
+
+	/* a server that went away is reported, instead of stopping the client */
+	signal(SIGPIPE, SIG_IGN);
+
+	/* ___The request - the number of arguments, then the arguments___ */
+	if (reserve_output(&request, REPLY_LENGTH) == FUNC_ERROR)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return QUIT_UPON_ERROR;
+	}
+	request.size = sprintf(request.chars, "%d\n", argc);
+
+	for (index = 0; index < argc; index++)
+	{
+		len = strlen(argv[index]) + 1;
+		if (reserve_output(&request, len) == FUNC_ERROR)
+		{
+			err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+			free_output_buffer(&request);
+			return QUIT_UPON_ERROR;
+		}
+		memcpy(request.chars + request.size, argv[index], len);
+		request.size += len;
+	}
+
+	fds[0] = STDIN_FILENO;
+	fds[1] = STDOUT_FILENO;
+	fds[2] = STDERR_FILENO;
+
+	if ((conn = open_socket(socketName, FALSE)) < 0 || (fds[PASSED_FDS - 1] = open(".", O_RDONLY)) < 0)
+	{
+		err_wo_line(stage, srvErrList[SRV_ERR_CONNECT], (char *)socketName);
+		if (conn >= 0)
+			close(conn);
+		free_output_buffer(&request);
+		return QUIT_UPON_ERROR;
+	}
+
+	/* ___Sending the request, with the file descriptors along with its first part___ */
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = request.chars;
+	iov.iov_len = request.size;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.chars;
+	msg.msg_controllen = sizeof(control.chars);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(PASSED_FDS * sizeof(int));
+	memcpy(CMSG_DATA(cmsg), fds, PASSED_FDS * sizeof(int));
+
+	while ((written = sendmsg(conn, &msg, 0)) < 0 && errno == EINTR)
+		;
+	for (sent = (int)written; written >= 0 && sent < request.size;)
+	{
+		if ((written = write(conn, request.chars + sent, request.size - sent)) > 0)
+			sent += (int)written;
+		else if (written < 0 && errno == EINTR)
+			written = 0;
+	}
+	close(fds[PASSED_FDS - 1]);
+	free_output_buffer(&request);
+
+	if (written < 0)
+	{
+		err_wo_line(stage, srvErrList[SRV_ERR_CONNECT], (char *)socketName);
+		close(conn);
+		return QUIT_UPON_ERROR;
+	}
+	shutdown(conn, SHUT_WR);
+
+	/* ___The reply - the exit status, once the request was handled___ */
+	for (len = 0; len < REPLY_LENGTH - 1;)
+	{
+		if ((written = read(conn, reply + len, REPLY_LENGTH - 1 - len)) > 0)
+			len += (int)written;
+		else if (written == 0 || errno != EINTR)
+			break;
+	}
+	reply[len] = '\0';
+	close(conn);
+
+	if (memchr(reply, '\n', len) == NULL)
+		err_wo_line(stage, srvErrList[SRV_ERR_REPLY], (char *)socketName);
+	else
+		res = atoi(reply);
+
+	return res;
+}
+
+/*___Error list___ */
+const char *srvErrList[] =
+{
+	"Could not listen on the following socket",
+	"Could not start a worker",
+	"Could not receive a request, or it is not valid",
+	"Could not switch to the standard streams and the working directory of a request",
+	"Could not connect to the server on the following socket",
+	"The server on the following socket did not reply"
+};
@@ -0,0 +1,47 @@
+/* ___The server's library___ */
+#ifndef SERVER_H
+#define SERVER_H
+
+/* ___Include___ */
+#include "general_lib.h"
+
+/* ___Definitions___ */
+#define DEFAULT_SERVER_WORKERS 4
+#define MAX_SERVER_WORKERS 64
+#define PASSED_FDS 4 /* the client's standard input, output and error, and its working directory */
+#define REQUEST_READ_SIZE 4096
+#define REPLY_LENGTH 16
+#define LISTEN_BACKLOG 64
+
+/* ___Enums___ */
+/* Enum defining error indices related to the server and its client. */
+/* prefix 'SRV' indicates server context */
+enum srvErrIndex
+{
+	SRV_ERR_SOCKET,	 /* Could not listen on the socket */
+	SRV_ERR_WORKER,	 /* Could not start a worker */
+	SRV_ERR_REQUEST, /* A request could not be received, or is not valid */
+	SRV_ERR_STREAMS, /* Could not switch to the client's streams and working directory */
+	SRV_ERR_CONNECT, /* Could not connect to the server */
+	SRV_ERR_REPLY	 /* The server did not reply */
+};
+
+/* ___Constants___ */
+extern const char *srvErrList[];
+
+/* ___Typedef___ */
+/* handles a request - its arguments are given as a command line, with the client's streams and working directory in place */
+typedef int (*requestHandler)(int argc, char *argv[], void *context);
+
+/* ___Prototypes___*/
+int open_socket(const char *socketName, int listening);
+int serve_requests(const errStage *stage, const char *socketName, int workers, requestHandler handle, void *context);
+long start_server_worker(const errStage *stage, int listenFd, requestHandler handle, void *context);
+int handle_request(const errStage *stage, int conn, requestHandler handle, void *context);
+int receive_request(int conn, int fds[], outputBuffer *request);
+char **split_request(outputBuffer *request, int *argc);
+int swap_streams(int fds[], int saved[]);
+void restore_streams(int saved[]);
+int run_client(const errStage *stage, const char *socketName, int argc, char *argv[]);
+
+#endif
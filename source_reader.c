@@ -0,0 +1,165 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "source_reader.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* ___The source reader___ */
+/* Source files are taken into memory whole, and are handed out line by line without copying. */
+
+/* Reads all of a file descriptor's contents into a growing buffer, for inputs that cannot be mapped (pipes, etc).
+   Parameters:
+   - fd: The file descriptor.
+   - source: The source file to fill.
+
+   Returns:
+   - 1 (TRUE) if the contents were read.
+   - -1 (FUNC_ERROR) if there was an error during reading or memory allocation.
+*/
+int read_source(int fd, sourceFile *source)
+{
+	long capacity = 0;
+	ssize_t bytesRead;
+
+	do
+	{
+		if (source->size + READ_CHUNK_SIZE > capacity)
+		{
+			char *temp;
+
+			capacity = (capacity == 0) ? READ_CHUNK_SIZE : capacity * 2;
+			if ((temp = (char *)realloc(source->chars, capacity)) == NULL)
+				return FUNC_ERROR;
+			source->chars = temp;
+		}
+
+		bytesRead = read(fd, source->chars + source->size, capacity - source->size);
+		if (bytesRead > 0)
+			source->size += bytesRead;
+
+	} while (bytesRead > 0);
+
+	return (bytesRead < 0) ? FUNC_ERROR : TRUE;
+}
+
+/* Takes a source file into memory.
+   Parameters:
+   - name: The file's name.
+   - source: The source file to fill.
+
+   Returns:
+   - 1 (TRUE) if the file is ready to be read.
+   - -1 (FUNC_ERROR) if the file could not be opened or read.
+
+   Notes:
+   - Regular files are mapped, other files (or files that could not be mapped) are read with as few calls as possible.
+*/
+int open_source(const char *name, sourceFile *source)
+{
+	struct stat info;
+	int fd,
+		res = TRUE;
+
+	source->chars = NULL;
+	source->size = source->pos = 0;
+	source->mapped = FALSE;
+
+	if ((fd = open(name, O_RDONLY)) < 0)
+		return FUNC_ERROR;
+
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+	{
+		/* an empty file has nothing to map */
+		if (info.st_size == 0)
+		{
+			close(fd);
+			return TRUE;
+		}
+
+		source->chars = (char *)mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (source->chars != (char *)MAP_FAILED)
+		{
+			source->size = info.st_size;
+			source->mapped = TRUE;
+			close(fd);
+			return TRUE;
+		}
+		source->chars = NULL;
+	}
+
+	if ((res = read_source(fd, source)) == FUNC_ERROR)
+		close_source(source);
+
+	close(fd);
+	return res;
+}
+
+/* Takes the standard input into memory, as a source file.
+   Parameters:
+   - source: The source file to fill.
+
+   Returns:
+   - 1 (TRUE) if the source is ready to be read.
+   - -1 (FUNC_ERROR) if it could not be read.
+*/
+int read_stdin(sourceFile *source)
+{
+	int res;
+
+	source->chars = NULL;
+	source->size = source->pos = 0;
+	source->mapped = FALSE;
+
+	if ((res = read_source(STDIN_FILENO, source)) == FUNC_ERROR)
+		close_source(source);
+
+	return res;
+}
+
+/* Hands out the next line of a source file.
+   Parameters:
+   - source: The source file.
+   - line: The slice to point at the line.
+
+   Returns:
+   - 1 (TRUE) if there was another line.
+   - 0 (FALSE) if the end of the file was reached.
+*/
+int next_line(sourceFile *source, lineSlice *line)
+{
+	const char *start,
+		*end;
+
+	if (source->pos >= source->size)
+		return FALSE;
+
+	start = source->chars + source->pos;
+	end = (const char *)memchr(start, '\n', source->size - source->pos);
+
+	/* the last line does not have to end with a newline character */
+	line->start = start;
+	line->len = (end == NULL) ? (int)(source->size - source->pos) : (int)(end - start);
+
+	source->pos += line->len + 1;
+	return TRUE;
+}
+
+/* Releases a source file's memory.
+   Parameters:
+   - source: The source file.
+*/
+void close_source(sourceFile *source)
+{
+	if (source->mapped)
+		munmap(source->chars, source->size);
+	else
+		free(source->chars);
+
+	source->chars = NULL;
+	source->size = source->pos = 0;
+	source->mapped = FALSE;
+}
@@ -0,0 +1,28 @@
+/* ___The source reader's library___ */
+#ifndef SOURCE_READER_H
+#define SOURCE_READER_H
+
+/* ___Include___ */
+#include "general_lib.h"
+
+/* ___Definitions___ */
+#define READ_CHUNK_SIZE 65536
+
+/* ___Typedef___ */
+/* a whole source file in memory - mapped if possible, read otherwise */
+typedef struct sourceFile
+{
+	char *chars;
+	long size;
+	long pos; /* where the next line starts */
+	int mapped;
+} sourceFile;
+
+/* ___Prototypes___*/
+int read_source(int fd, sourceFile *source);
+int open_source(const char *name, sourceFile *source);
+int read_stdin(sourceFile *source);
+int next_line(sourceFile *source, lineSlice *line);
+void close_source(sourceFile *source);
+
+#endif
@@ -0,0 +1,230 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "stats.h"
+
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ___The run statistics___ */
+/* With -stats, the wall and CPU time of every stage of a file is measured, along with the files it opened,
+   the bytes it read and wrote, and the peak resident set of its process.
+   The statistics of all of the files are printed in a table at the end of the run, followed by their totals. */
+
+/* Reads the clocks.
+   Parameters:
+   - now: Where the wall time and the CPU time (user and system) of the process are put.
+   - withChildren: Whether the CPU time of the child processes that were waited for is added.
+*/
+void read_clock(stageTime *now, int withChildren)
+{
+	struct timespec wall;
+	struct rusage usage;
+
+	clock_gettime(CLOCK_MONOTONIC, &wall);
+	now->wall = (double)wall.tv_sec + (double)wall.tv_nsec / 1e9;
+
+	getrusage(RUSAGE_SELF, &usage);
+	now->cpu = (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+
+	if (withChildren)
+	{
+		getrusage(RUSAGE_CHILDREN, &usage);
+		now->cpu += (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+	}
+}
+
+/* Adds the time since a point to a total.
+   Parameters:
+   - total: The total.
+   - start: The point, from read_clock.
+   - withChildren: Whether the point includes the CPU time of child processes.
+*/
+void add_elapsed(stageTime *total, const stageTime *start, int withChildren)
+{
+	stageTime now;
+
+	read_clock(&now, withChildren);
+	total->wall += now.wall - start->wall;
+	total->cpu += now.cpu - start->cpu;
+}
+
+/* Starts measuring a stage of a file.
+   Parameters:
+   - stats: The file's statistics, or NULL if they are not kept.
+   - clock: Where the starting point is put.
+*/
+void start_clock(fileStats *stats, stageTime *clock)
+{
+	if (stats != NULL)
+		read_clock(clock, FALSE);
+}
+
+/* Adds the time of a stage to a file's statistics.
+   Parameters:
+   - stats: The file's statistics, or NULL if they are not kept.
+   - stage: The statsStage.
+   - clock: The stage's starting point.
+*/
+void stop_clock(fileStats *stats, int stage, const stageTime *clock)
+{
+	if (stats != NULL)
+		add_elapsed(&stats->stages[stage], clock, FALSE);
+}
+
+/* Starts measuring a file.
+   Parameters:
+   - stats: The file's statistics, or NULL if they are not kept.
+   - clock: Where the file's starting point is put.
+
+   Notes:
+   - The files the file opens, and the bytes it reads and writes, are counted straight into its statistics, by the stages it goes through.
+*/
+void start_file_stats(fileStats *stats, stageTime *clock)
+{
+	if (stats != NULL)
+		read_clock(clock, FALSE);
+}
+
+/* Completes the statistics of a file - its time and the peak resident set.
+   Parameters:
+   - stats: The file's statistics, or NULL if they are not kept.
+   - clock: The file's starting point.
+*/
+void finish_file_stats(fileStats *stats, const stageTime *clock)
+{
+	struct rusage usage;
+
+	if (stats == NULL)
+		return;
+
+	add_elapsed(&stats->stages[statsStage_file], clock, FALSE);
+
+	getrusage(RUSAGE_SELF, &usage);
+	stats->peakRss = (long)usage.ru_maxrss;
+}
+
+/* Allocates the statistics of a run's files, all zero.
+   Parameters:
+   - count: The number of files.
+   - shared: Whether the files are assembled by workers, which write their statistics into memory shared with the parent.
+
+   Returns:
+   - The statistics, or NULL if there was an error during allocation.
+
+   Notes:
+   - Shared memory is mapped from a temporary file, which is removed as soon as it is closed.
+*/
+fileStats *alloc_file_stats(int count, int shared)
+{
+	fileStats *stats = NULL;
+
+	FILE *backing;
+
+	size_t size = (count + 1) * sizeof(fileStats);
+
+	if (!shared)
+		return (fileStats *)calloc(count + 1, sizeof(fileStats));
+
+	if ((backing = tmpfile()) == NULL)
+		return NULL;
+
+	if (ftruncate(fileno(backing), (off_t)size) == 0)
+	{
+		stats = (fileStats *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(backing), 0);
+		if (stats == (fileStats *)MAP_FAILED)
+			stats = NULL;
+	}
+
+	fclose(backing);
+	return stats;
+}
+
+/* Frees the statistics of a run's files.
+   Parameters:
+   - stats: The statistics.
+   - count: The number of files.
+   - shared: Whether they were shared with workers.
+*/
+void free_file_stats(fileStats *stats, int count, int shared)
+{
+	if (stats == NULL)
+		return;
+
+	if (shared)
+		munmap(stats, (count + 1) * sizeof(fileStats));
+	else
+		free(stats);
+}
+
+/* Prints a row of the statistics table.
+   Parameters:
+   - stats: The statistics.
+   - name: The row's name.
+*/
+void print_stats_row(const fileStats *stats, const char *name)
+{
+	int stage;
+
+	for (stage = 0; stage < statsStage_end; stage++)
+		printf("%9.3f %9.3f  ", stats->stages[stage].wall * MS_PER_SEC, stats->stages[stage].cpu * MS_PER_SEC);
+
+	printf("%9ld %10ld %10ld %6d  %-9s  %s\n", stats->peakRss, stats->io.bytesRead, stats->io.bytesWritten,
+		   stats->io.filesOpened, stats->result, name);
+}
+
+/* Prints the statistics of a run - a row for every file, a row of their totals, and the times of the whole run.
+   Parameters:
+   - files: The files' names, without the .as extension.
+   - stats: The files' statistics.
+   - count: The number of files.
+   - resNamesTime: The time the reserved names index took to build.
+   - runTime: The time of the whole run, with the CPU time of its workers.
+
+   Notes:
+   - The peak resident set of the totals is the largest of the files'.
+*/
+void print_stats(char **files, fileStats stats[], int count, const stageTime *resNamesTime, const stageTime *runTime)
+{
+	fileStats total;
+
+	char name[MAX_LINE_LENGTH];
+
+	int index,
+		stage;
+
+	memset(&total, 0, sizeof(total));
+	total.result = "";
+
+	printf("Statistics (times in milliseconds):\n");
+	printf("%19s  %19s  %19s  %19s  %9s %10s %10s %6s  %-9s  %s\n", "pre processing", "first pass", "second pass", "the file",
+		   "peak RSS", "read", "written", "files", "result", "file");
+	printf("%9s %9s  %9s %9s  %9s %9s  %9s %9s  %9s %10s %10s\n", "wall", "cpu", "wall", "cpu", "wall", "cpu", "wall", "cpu",
+		   "KB", "bytes", "bytes");
+
+	for (index = 0; index < count; index++)
+	{
+		sprintf(name, "%.*s.as", MAX_LINE_LENGTH - EXT_LENGTH, files[index]);
+		print_stats_row(&stats[index], name);
+
+		for (stage = 0; stage < statsStage_end; stage++)
+		{
+			total.stages[stage].wall += stats[index].stages[stage].wall;
+			total.stages[stage].cpu += stats[index].stages[stage].cpu;
+		}
+		total.io.bytesRead += stats[index].io.bytesRead;
+		total.io.bytesWritten += stats[index].io.bytesWritten;
+		total.io.filesOpened += stats[index].io.filesOpened;
+		if (stats[index].peakRss > total.peakRss)
+			total.peakRss = stats[index].peakRss;
+	}
+
+	sprintf(name, "all %d files", count);
+	print_stats_row(&total, name);
+
+	printf("The reserved names took %.3f ms (%.3f ms of CPU), and the run took %.3f ms (%.3f ms of CPU, with its workers).\n\n",
+		   resNamesTime->wall * MS_PER_SEC, resNamesTime->cpu * MS_PER_SEC, runTime->wall * MS_PER_SEC, runTime->cpu * MS_PER_SEC);
+}
@@ -0,0 +1,51 @@
+/* ___The run statistics' library___ */
+#ifndef STATS_H
+#define STATS_H
+
+/* ___Include___ */
+#include "general_lib.h"
+
+/* ___Definitions___ */
+#define MS_PER_SEC 1000.0
+
+/* ___Enums___ */
+/* the parts of a file's time that are measured */
+enum statsStage
+{
+	statsStage_pp,
+	statsStage_fp,
+	statsStage_sp,
+	statsStage_file, /* the whole file, with the cache and its report */
+	statsStage_end
+};
+
+/* ___Typedef___ */
+/* a wall time and a CPU time, in seconds - of a point in time, or of how long something took */
+typedef struct stageTime
+{
+	double wall,
+		cpu;
+} stageTime;
+
+/* what a file took */
+typedef struct fileStats
+{
+	stageTime stages[statsStage_end];
+	ioCounts io;
+	long peakRss;		/* the peak resident set of the process by the end of the file, in kilobytes */
+	const char *result; /* what became of the file */
+} fileStats;
+
+/* ___Prototypes___*/
+void read_clock(stageTime *now, int withChildren);
+void add_elapsed(stageTime *total, const stageTime *start, int withChildren);
+void start_clock(fileStats *stats, stageTime *clock);
+void stop_clock(fileStats *stats, int stage, const stageTime *clock);
+void start_file_stats(fileStats *stats, stageTime *clock);
+void finish_file_stats(fileStats *stats, const stageTime *clock);
+fileStats *alloc_file_stats(int count, int shared);
+void free_file_stats(fileStats *stats, int count, int shared);
+void print_stats_row(const fileStats *stats, const char *name);
+void print_stats(char **files, fileStats stats[], int count, const stageTime *resNamesTime, const stageTime *runTime);
+
+#endif
@@ -0,0 +1,65 @@
+#!/bin/sh
+# A file assembled with -cache is stored on its first run, and restored on the next one:
+# the second run must be a hit, and must leave the same output files as the first.
+# Usage: tests/cache.sh [assembler]
+
+ASSEMBLER=${1:-./assembler}
+DIR=$(mktemp -d)
+FAILED=0
+
+trap 'rm -rf "$DIR"' EXIT
+
+# Runs the assembler with a cache, and checks the hits and misses it reports.
+# Parameters: the check's name, the expected hits and misses, and the arguments before the file.
+check()
+{
+	name=$1
+	expected="Cache: $2 hits, $3 misses."
+	shift 3
+
+	rm -f "$DIR"/prog.am "$DIR"/prog.ob "$DIR"/prog.obj "$DIR"/prog.ext "$DIR"/prog.ent
+	"$ASSEMBLER" -cache "$DIR/cache" "$@" "$DIR/prog" > "$DIR/out" 2>&1
+	status=$?
+
+	if [ "$status" -ne 0 ] || ! grep -q "^$expected\$" "$DIR/out"; then
+		echo "FAIL: $name (exit status $status)"
+		cat "$DIR/out"
+		FAILED=1
+	else
+		echo "ok: $name"
+	fi
+}
+
+# Checks that the output files are the same as the ones kept in a directory.
+# Parameters: the check's name, and the directory.
+same_outputs()
+{
+	for file in "$2"/*; do
+		if ! cmp -s "$file" "$DIR/$(basename "$file")"; then
+			echo "FAIL: $1 ($(basename "$file") differs)"
+			FAILED=1
+			return
+		fi
+	done
+	if [ "$(ls "$DIR"/prog.* | wc -l)" -ne "$(ls "$2" | wc -l)" ]; then
+		echo "FAIL: $1 (the output files differ)"
+		FAILED=1
+		return
+	fi
+	echo "ok: $1"
+}
+
+printf '.entry MAIN\n.extern PUTC\nmcr twice\njsr PUTC\njsr PUTC\nendmcr\nMAIN: mov #72, r1\ntwice\nhlt\nMSG: .string "ok"\n' > "$DIR/prog.as"
+
+check miss 0 1 -am
+mkdir "$DIR/first"
+cp "$DIR"/prog.* "$DIR/first"
+
+check hit 1 0 -am
+same_outputs restored "$DIR/first"
+
+# the options are part of the key, so a -bin run is a miss of its own
+check bin_miss 0 1 -bin
+check bin_hit 1 0 -bin
+
+exit $FAILED
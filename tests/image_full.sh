@@ -0,0 +1,55 @@
+#!/bin/sh
+# The code and data images hold 3996 words, after the load address of 100.
+# A source past them must be reported as not fitting in the memory, instead of being written past the images.
+# Usage: tests/image_full.sh [assembler]
+
+ASSEMBLER=${1:-./assembler}
+DIR=$(mktemp -d)
+FAILED=0
+
+trap 'rm -rf "$DIR"' EXIT
+
+# Writes <name>.as of the given number of one word instructions, and the given lines after them.
+gen_source()
+{
+	awk -v count="$2" 'BEGIN { for (i = 0; i < count; i++) print "inc r1" }' > "$DIR/$1.as"
+	printf "%s" "$3" >> "$DIR/$1.as"
+}
+
+# Assembles a source, and checks its exit status and whether the memory error was reported.
+# Parameters: the source's name, whether it is expected to fail (0 or 1), and the expected count of the error.
+check()
+{
+	"$ASSEMBLER" "$DIR/$1" > "$DIR/$1.out" 2>&1
+	status=$?
+	errors=$(grep -c "The program does not fit in the memory" "$DIR/$1.out")
+
+	[ "$status" -ne 0 ] && failed=1 || failed=0
+
+	if [ "$failed" -ne "$2" ] || [ "$errors" -ne "$3" ]; then
+		echo "FAIL: $1 (exit status $status, $errors memory errors)"
+		cat "$DIR/$1.out"
+		FAILED=1
+	else
+		echo "ok: $1"
+	fi
+}
+
+# inc of a register takes two words, so 1998 of them fill the images exactly
+gen_source fits 1998 ""
+check fits 0 0
+
+# one more instruction is past the images, and is reported at its line
+gen_source code_full 1999 ""
+check code_full 1 1
+
+# the code fits on its own, but the data placed after it does not
+gen_source data_full 1998 "DATA: .data 1
+"
+check data_full 1 1
+
+# a source far past the images is reported once for every instruction that does not fit, and does not crash
+gen_source far_past 2100 ""
+check far_past 1 102
+
+exit $FAILED
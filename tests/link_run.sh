@@ -0,0 +1,63 @@
+#!/bin/sh
+# Two files, each using the other's entries, are assembled, linked into a single image, and run.
+# The linked entries must be at their addresses in the image, the program must print what it did when it was one file,
+# and a file whose .ext file is missing must not be linked.
+# Usage: tests/link_run.sh [assembler] [linker] [emulator]
+
+ASSEMBLER=${1:-./assembler}
+LINKER=${2:-./linker}
+EMULATOR=${3:-./emulator}
+DIR=$(mktemp -d)
+FAILED=0
+
+trap 'rm -rf "$DIR"' EXIT
+
+# Reports a check, given its name and whether it passed (0 or 1), with the output of the command it checked.
+report()
+{
+	if [ "$2" -eq 1 ]; then
+		echo "ok: $1"
+	else
+		echo "FAIL: $1"
+		cat "$DIR/out"
+		FAILED=1
+	fi
+}
+
+cat > "$DIR/main.as" << 'EOF'
+.extern PUTC
+.extern MSG
+MAIN: mov #72, r1
+jsr PUTC
+mov #105, r1
+jsr PUTC
+prn MSG
+hlt
+EOF
+
+cat > "$DIR/lib.as" << 'EOF'
+.entry PUTC
+.entry MSG
+PUTC: prn r1
+rts
+MSG: .string "!"
+EOF
+
+"$ASSEMBLER" "$DIR/main" "$DIR/lib" > "$DIR/out" 2>&1
+report assemble $([ $? -eq 0 ] && echo 1 || echo 0)
+
+# main's 13 code words come first, then lib's 3, and lib's data after all of the code
+"$LINKER" -o "$DIR/prog" "$DIR/main" "$DIR/lib" > "$DIR/out" 2>&1
+report link $([ $? -eq 0 ] && printf 'PUTC\t0113\nMSG\t0116\n' | cmp -s - "$DIR/prog.ent" && echo 1 || echo 0)
+
+# main prints two characters through lib's PUTC, and then lib's string
+"$EMULATOR" "$DIR/prog" > "$DIR/run" 2> "$DIR/out"
+report run $([ $? -eq 0 ] && printf 'Hi!' | cmp -s - "$DIR/run" && echo 1 || echo 0)
+
+# without its .ext file, main's references to lib are left unpatched
+rm "$DIR/main.ext" "$DIR/prog.ob"
+"$LINKER" -o "$DIR/prog" "$DIR/main" "$DIR/lib" > "$DIR/out" 2>&1
+status=$?
+report missing_ext $([ $status -ne 0 ] && [ ! -f "$DIR/prog.ob" ] && [ "$(grep -c 'no .ext line refers to it' "$DIR/out")" -eq 3 ] && echo 1 || echo 0)
+
+exit $FAILED
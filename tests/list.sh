@@ -0,0 +1,42 @@
+#!/bin/sh
+# Files named in a null separated list (-list with -0) are all assembled, including names with spaces,
+# and only the files that failed are reported, each on a line of its own.
+# Usage: tests/list.sh [assembler]
+
+ASSEMBLER=$(cd "$(dirname "${1:-./assembler}")" && pwd)/$(basename "${1:-./assembler}")
+DIR=$(mktemp -d)
+FAILED=0
+
+trap 'rm -rf "$DIR"' EXIT
+
+# Reports a check, given its name and whether it passed (0 or 1), with the output of the run it checked.
+report()
+{
+	if [ "$2" -eq 1 ]; then
+		echo "ok: $1"
+	else
+		echo "FAIL: $1"
+		cat "$DIR/out" "$DIR/err"
+		FAILED=1
+	fi
+}
+
+printf 'hlt\n' > "$DIR/with space.as"
+printf 'inc r9\n' > "$DIR/bad.as"
+printf 'MAIN: mov #1, r1\nhlt\n' > "$DIR/last.as"
+
+# an empty name is skipped, and the last name needs no separator after it
+printf 'with space\0bad\0\0last' > "$DIR/files"
+
+cd "$DIR" || exit 1
+"$ASSEMBLER" -list files -0 > out 2> err
+status=$?
+report list_file $([ $status -ne 0 ] && [ "$(cat out)" = "bad.as: failed" ] && [ -f "with space.ob" ] && [ -f last.ob ] && [ ! -f bad.ob ] && echo 1 || echo 0)
+
+# the list read from the standard input
+rm -f ./*.ob
+printf 'with space\0last\0' | "$ASSEMBLER" -list - -0 > out 2> err
+status=$?
+report list_stdin $([ $status -eq 0 ] && [ ! -s out ] && [ -f "with space.ob" ] && [ -f last.ob ] && echo 1 || echo 0)
+
+exit $FAILED
@@ -0,0 +1,54 @@
+#!/bin/sh
+# Files assembled through a running server must come out as they do when the assembler is run on its own:
+# the same standard output and error, the same exit status, and the same output files.
+# Usage: tests/server.sh [assembler]
+
+ASSEMBLER=$(cd "$(dirname "${1:-./assembler}")" && pwd)/$(basename "${1:-./assembler}")
+DIR=$(mktemp -d)
+FAILED=0
+SERVER=
+
+trap '[ -n "$SERVER" ] && kill "$SERVER"; rm -rf "$DIR"' EXIT
+
+# Writes the sources into a directory - one that assembles, and one with errors.
+gen_sources()
+{
+	mkdir "$1"
+	printf '.entry MAIN\n.extern PUTC\nMAIN: mov #72, r1\njsr PUTC\nhlt\n' > "$1/good.as"
+	printf 'inc r9\nmcr\n' > "$1/bad.as"
+}
+
+# Runs the assembler in a directory, keeping its output and exit status there.
+# Parameters: the directory, and the arguments before the files.
+run()
+{
+	dir=$1
+	shift
+	(cd "$dir" && "$ASSEMBLER" "$@" good bad > stdout 2> stderr; echo $? > status)
+}
+
+gen_sources "$DIR/local"
+gen_sources "$DIR/remote"
+
+"$ASSEMBLER" -serve "$DIR/socket" -j 2 > "$DIR/server.out" 2>&1 &
+SERVER=$!
+
+# the server is ready once its socket exists
+tries=0
+while [ ! -S "$DIR/socket" ] && [ $tries -lt 50 ]; do
+	sleep 0.1
+	tries=$((tries + 1))
+done
+
+run "$DIR/local"
+run "$DIR/remote" -connect "$DIR/socket"
+
+if diff -r "$DIR/local" "$DIR/remote" > "$DIR/diff" 2>&1; then
+	echo "ok: connect"
+else
+	echo "FAIL: connect"
+	cat "$DIR/diff" "$DIR/server.out"
+	FAILED=1
+fi
+
+exit $FAILED
@@ -0,0 +1,344 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "worker_pool.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <errno.h>
+#include <unistd.h>
+
+/* ___The worker pool___ */
+/* Jobs are run in worker processes, at most a given number at a time, the largest jobs first.
+   The standard output and error of every job are collected through pipes, and printed in the order of the jobs,
+   so the output is the same as if the jobs were run one after the other.
+   When the standard output and error are the same file (as a terminal), a job writes both to a single pipe,
+   which keeps its lines in the order they were printed. */
+
+/* Finds the size of a job's input file.
+   Parameters:
+   - name: The file's name.
+
+   Returns:
+   - The size in bytes, or 0 if the file does not exist.
+*/
+long input_size(const char *name)
+{
+	struct stat info;
+
+	return (stat(name, &info) == 0) ? (long)info.st_size : 0;
+}
+
+/* Orders jobs from the largest to the smallest, for qsort.
+   Parameters:
+   - first, second: Pointers to the jobs.
+
+   Returns:
+   - A negative, zero, or positive number, as the first job is larger, of the same size, or smaller.
+*/
+int compare_jobs(const void *first, const void *second)
+{
+	const poolJob *firstJob = (const poolJob *)first,
+				  *secondJob = (const poolJob *)second;
+
+	if (firstJob->size != secondJob->size)
+		return (firstJob->size > secondJob->size) ? -1 : 1;
+
+	/* jobs of the same size are started in order */
+	return firstJob->job - secondJob->job;
+}
+
+/* Checks whether the standard output and error are the same file, so that the order of their lines shows.
+   Returns:
+   - 1 (TRUE) if they are the same file.
+   - 0 (FALSE) if they are different files, or either of them could not be checked.
+*/
+int shared_output(void)
+{
+	struct stat out,
+		err;
+
+	if (fstat(STDOUT_FILENO, &out) != 0 || fstat(STDERR_FILENO, &err) != 0)
+		return FALSE;
+
+	return out.st_dev == err.st_dev && out.st_ino == err.st_ino;
+}
+
+/* Starts a job in a new worker process, whose standard output and error are pipes.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - job: The job's index.
+   - output: Where the job's pipes and process are recorded.
+   - shared: Whether the standard output and error share a single pipe.
+   - run: The function that runs the job.
+   - context: Passed on to run.
+
+   Returns:
+   - 1 (TRUE) if the worker was started.
+   - -1 (FUNC_ERROR) if a pipe or the process could not be created.
+*/
+int start_job(const errStage *stage, int job, jobOutput *output, int shared, workerJob run, void *context)
+{
+	int outPipe[2],
+		errPipe[2] = {-1, -1},
+		res;
+
+	pid_t pid;
+
+	if (pipe(outPipe) != 0)
+	{
+		err_wo_line(stage, poolErrList[POOL_ERR_START], NULL);
+		return FUNC_ERROR;
+	}
+	if (!shared && pipe(errPipe) != 0)
+	{
+		close(outPipe[0]);
+		close(outPipe[1]);
+		err_wo_line(stage, poolErrList[POOL_ERR_START], NULL);
+		return FUNC_ERROR;
+	}
+
+	/* anything still buffered would be printed by the worker as well */
+	fflush(stdout);
+	fflush(stderr);
+
+	if ((pid = fork()) < 0)
+	{
+		close(outPipe[0]);
+		close(outPipe[1]);
+		if (!shared)
+		{
+			close(errPipe[0]);
+			close(errPipe[1]);
+		}
+		err_wo_line(stage, poolErrList[POOL_ERR_START], NULL);
+		return FUNC_ERROR;
+	}
+
+	/* ___The worker___ */
+	if (pid == 0)
+	{
+		close(outPipe[0]);
+		dup2(outPipe[1], STDOUT_FILENO);
+		dup2(shared ? outPipe[1] : errPipe[1], STDERR_FILENO);
+		close(outPipe[1]);
+		if (!shared)
+		{
+			close(errPipe[0]);
+			close(errPipe[1]);
+		}
+
+		res = run(job, context);
+
+		fflush(stdout);
+		fflush(stderr);
+		_exit(res);
+	}
+
+	close(outPipe[1]);
+	if (!shared)
+		close(errPipe[1]);
+
+	output->fds[0] = outPipe[0];
+	output->fds[1] = errPipe[0];
+	output->pid = (long)pid;
+	return TRUE;
+}
+
+/* Waits for output from the running jobs, and collects it. A job whose pipes were both closed is waited for, and marked as done.
+   Parameters:
+   - outputs: The outputs of all of the jobs, indexed by job.
+   - running: The indices of the running jobs.
+   - runningCount: The number of running jobs.
+
+   Returns:
+   - 1 (TRUE) if the output was collected.
+   - -1 (FUNC_ERROR) if polling or reading failed, or there was an error during memory allocation.
+*/
+int collect_output(jobOutput outputs[], int running[], int runningCount)
+{
+	struct pollfd fds[2 * MAX_WORKERS];
+
+	int index,
+		stream,
+		fdCount = 0,
+		status;
+
+	ssize_t len;
+
+	for (index = 0; index < runningCount; index++)
+	{
+		for (stream = 0; stream < 2; stream++)
+		{
+			if (outputs[running[index]].fds[stream] < 0)
+				continue;
+
+			fds[fdCount].fd = outputs[running[index]].fds[stream];
+			fds[fdCount].events = POLLIN;
+			fds[fdCount].revents = 0;
+			fdCount++;
+		}
+	}
+
+	if (fdCount > 0 && poll(fds, fdCount, -1) < 0)
+		return (errno == EINTR) ? TRUE : FUNC_ERROR;
+
+	for (index = 0; index < runningCount; index++)
+	{
+		jobOutput *current = &outputs[running[index]];
+
+		for (stream = 0; stream < 2; stream++)
+		{
+			outputBuffer *buffer = (stream == 0) ? &current->out : &current->err;
+			int fd = current->fds[stream],
+				ready = FALSE,
+				pos;
+
+			if (fd < 0)
+				continue;
+
+			for (pos = 0; pos < fdCount; pos++)
+			{
+				if (fds[pos].fd == fd && fds[pos].revents != 0)
+					ready = TRUE;
+			}
+			if (!ready)
+				continue;
+
+			if (reserve_output(buffer, PIPE_READ_SIZE) == FUNC_ERROR)
+				return FUNC_ERROR;
+
+			if ((len = read(fd, buffer->chars + buffer->size, PIPE_READ_SIZE)) > 0)
+				buffer->size += (int)len;
+			else if (len == 0 || errno != EINTR)
+			{
+				close(fd);
+				current->fds[stream] = -1;
+			}
+		}
+
+		/* the worker closed both of its pipes */
+		if (current->fds[0] < 0 && current->fds[1] < 0)
+		{
+			current->result = (waitpid((pid_t)current->pid, &status, 0) > 0 && WIFEXITED(status)) ? WEXITSTATUS(status) : FUNC_ERROR;
+			current->done = TRUE;
+		}
+	}
+	return TRUE;
+}
+
+/* Runs jobs in worker processes, and prints their output in the order of the jobs.
+   Parameters:
+   - stage: The stage in which the error occurred.
+   - workers: The maximal number of jobs that run at a time (at most MAX_WORKERS).
+   - jobs: The jobs (numbered from 0 to jobCount - 1) and the sizes of their inputs, reordered from the largest.
+   - jobCount: The number of jobs.
+   - run: The function that runs a job, in a worker.
+   - context: Passed on to run.
+   - results: Where the result of every job is put, by job - the value run returned,
+	 or -1 (FUNC_ERROR) if the job could not be started or did not finish.
+
+   Returns:
+   - 1 (TRUE) if all of the jobs were run.
+   - -1 (FUNC_ERROR) if there was an error during memory allocation.
+*/
+int run_worker_pool(const errStage *stage, int workers, poolJob jobs[], int jobCount, workerJob run, void *context, int results[])
+{
+	jobOutput *outputs;
+
+	int running[MAX_WORKERS];
+
+	int index,
+		job,
+		status,
+		shared = shared_output(),
+		runningCount = 0,
+		next = 0,
+		printed = 0;
+
+	if ((outputs = (jobOutput *)calloc(jobCount, sizeof(jobOutput))) == NULL)
+	{
+		err_wo_line(stage, generalErrList[GEN_ERR_MALLOC], NULL);
+		return FUNC_ERROR;
+	}
+
+	if (workers > MAX_WORKERS)
+		workers = MAX_WORKERS;
+
+	/* the largest jobs are started first, so they do not hold the rest back at the end */
+	qsort(jobs, jobCount, sizeof(poolJob), compare_jobs);
+
+	while (printed < jobCount)
+	{
+		/* ___Starting jobs, while there are free workers___ */
+		while (runningCount < workers && next < jobCount)
+		{
+			job = jobs[next++].job;
+
+			if (start_job(stage, job, &outputs[job], shared, run, context) == TRUE)
+				running[runningCount++] = job;
+			else
+			{
+				outputs[job].result = FUNC_ERROR;
+				outputs[job].done = TRUE;
+			}
+		}
+
+		/* ___Collecting the output of the running jobs___ */
+		if (runningCount > 0 && collect_output(outputs, running, runningCount) == FUNC_ERROR)
+		{
+			/* the running jobs are waited for, and their output so far is kept */
+			err_wo_line(stage, poolErrList[POOL_ERR_WAIT], NULL);
+			for (index = 0; index < runningCount; index++)
+			{
+				jobOutput *current = &outputs[running[index]];
+
+				if (current->fds[0] >= 0)
+					close(current->fds[0]);
+				if (current->fds[1] >= 0)
+					close(current->fds[1]);
+				current->fds[0] = current->fds[1] = -1;
+				waitpid((pid_t)current->pid, &status, 0);
+				current->result = FUNC_ERROR;
+				current->done = TRUE;
+			}
+		}
+
+		for (index = 0; index < runningCount;)
+		{
+			if (outputs[running[index]].done)
+				running[index] = running[--runningCount];
+			else
+				index++;
+		}
+
+		/* ___Printing the output of the finished jobs, in order___ */
+		while (printed < jobCount && outputs[printed].done)
+		{
+			jobOutput *current = &outputs[printed++];
+
+			if (current->out.size > 0)
+				fwrite(current->out.chars, 1, current->out.size, stdout);
+			fflush(stdout);
+			if (current->err.size > 0)
+				fwrite(current->err.chars, 1, current->err.size, stderr);
+			fflush(stderr);
+
+			results[printed - 1] = current->result;
+
+			free_output_buffer(&current->out);
+			free_output_buffer(&current->err);
+		}
+	}
+
+	free(outputs);
+	return TRUE;
+}
+
+/*___Error list___ */
+const char *poolErrList[] =
+{
+	"Could not start a worker",
+	"Could not wait for the output of the workers"
+};
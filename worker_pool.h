@@ -0,0 +1,54 @@
+/* ___The worker pool's library___ */
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+/* ___Include___ */
+#include "general_lib.h"
+
+/* ___Definitions___ */
+#define PIPE_READ_SIZE 4096
+#define MAX_WORKERS 256
+
+/* ___Enums___ */
+/* Enum defining error indices related to the worker pool. */
+/* prefix 'POOL' indicates worker pool context */
+enum poolErrIndex
+{
+	POOL_ERR_START, /* Could not create a pipe or a process for a worker */
+	POOL_ERR_WAIT	/* Could not wait for the workers' output */
+};
+
+/* ___Constants___ */
+extern const char *poolErrList[];
+
+/* ___Typedef___ */
+/* runs a job in a worker, and returns its result (from 0 to 255) */
+typedef int (*workerJob)(int job, void *context);
+
+/* a job and the size of its input, to start the largest jobs first */
+typedef struct poolJob
+{
+	long size;
+	int job;
+} poolJob;
+
+/* the output of a job, collected until it can be printed in order */
+typedef struct jobOutput
+{
+	outputBuffer out,
+		err;
+	int fds[2]; /* the read ends of the job's stdout and stderr pipes (a single pipe in fds[0] if they share it), -1 once closed */
+	long pid;
+	int done,
+		result; /* the value the job returned, or -1 (FUNC_ERROR) */
+} jobOutput;
+
+/* ___Prototypes___*/
+long input_size(const char *name);
+int compare_jobs(const void *first, const void *second);
+int shared_output(void);
+int start_job(const errStage *stage, int job, jobOutput *output, int shared, workerJob run, void *context);
+int collect_output(jobOutput outputs[], int running[], int runningCount);
+int run_worker_pool(const errStage *stage, int workers, poolJob jobs[], int jobCount, workerJob run, void *context, int results[]);
+
+#endif